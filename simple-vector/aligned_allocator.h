@@ -0,0 +1,68 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <new>
+
+#include "simple_vector.h"
+
+// Аллокатор, выравнивающий каждый блок на Align байт. Блок занимает целое число Align-байтовых
+// векторов, и allocate_at_least отдаёт во вместимость все целые элементы, которые в нём помещаются.
+// Если sizeof(Type) делит Align, GetCapacity() * sizeof(Type) кратно Align, и SIMD-цикл может
+// обработать хвост до GetCapacity() без проверки границ. Иначе в конце блока остаётся меньше
+// sizeof(Type) байт, которые не входят во вместимость, но читать их векторной загрузкой безопасно.
+// Элементы хвоста за GetSize() не сконструированы: читать их можно только для тривиальных типов
+template <typename Type, size_t Align = 64>
+class AlignedAllocator {
+public:
+    using value_type = Type;
+
+    static_assert(Align >= alignof(Type) && (Align & (Align - 1)) == 0,
+                  "Align must be a power of two not less than alignof(Type)");
+
+    template <typename Other>
+    struct rebind {
+        using other = AlignedAllocator<Other, Align>;
+    };
+
+    struct Result {
+        Type* ptr;
+        size_t count;
+    };
+
+    static constexpr size_t kAlignment = Align;
+
+    AlignedAllocator() noexcept = default;
+
+    template <typename Other>
+    AlignedAllocator(const AlignedAllocator<Other, Align>&) noexcept {
+    }
+
+    Type* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    Result allocate_at_least(size_t n) {
+        if (n > (std::numeric_limits<size_t>::max() - Align) / sizeof(Type)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = (n * sizeof(Type) + Align - 1) / Align * Align;
+        void* p = ::operator new(bytes, std::align_val_t(Align));
+        return {static_cast<Type*>(p), bytes / sizeof(Type)};
+    }
+
+    void deallocate(Type* p, size_t) noexcept {
+        ::operator delete(p, std::align_val_t(Align));
+    }
+
+    template <typename Other>
+    bool operator==(const AlignedAllocator<Other, Align>&) const noexcept {
+        return true;
+    }
+};
+
+// SimpleVector, у которого begin() выровнен на Align байт, а блок кратен Align байтам
+// (вместимость кратна Align байтам, если sizeof(Type) делит Align)
+template <typename Type, size_t Align = 64>
+using AlignedSimpleVector = SimpleVector<Type, AlignedAllocator<Type, Align>>;
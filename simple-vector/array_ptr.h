@@ -1,41 +1,99 @@
 #pragma once
 
 #include <cstdlib>
+#include <memory>
 #include <utility>
 
-template <typename Type>
+#include "memory_utils.h"
+
+// Владеет неинициализированным блоком памяти под size элементов типа Type,
+// полученным от аллокатора Allocator (совместим с std::allocator_traits).
+// Если аллокатор умеет allocate_at_least, size - фактический размер полученного блока.
+// Конструирование и разрушение элементов - забота владельца (SimpleVector)
+template <typename Type, typename Allocator = std::allocator<Type>>
 class ArrayPtr {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
 public:
+    using AllocatorType = Allocator;
+
     ArrayPtr() = default;
 
-    explicit ArrayPtr(size_t size) {
-        raw_ptr_ = size == 0 ? nullptr : new Type[size]();
+    explicit ArrayPtr(const Allocator& alloc) noexcept
+            : alloc_(alloc)
+    {
+    }
+
+    explicit ArrayPtr(size_t size, const Allocator& alloc = Allocator())
+            : alloc_(alloc)
+    {
+        if (size == 0) {
+            return;
+        }
+        if constexpr (detail::HasAllocateAtLeast<Allocator>::value) {
+            // весь выделенный аллокатором хвост блока становится доступен
+            const auto result = alloc_.allocate_at_least(size);
+            raw_ptr_ = result.ptr;
+            size_ = result.count;
+        } else {
+            raw_ptr_ = AllocTraits::allocate(alloc_, size);
+            size_ = size;
+        }
     }
 
-    explicit ArrayPtr(Type* raw_ptr) noexcept
-            : raw_ptr_(raw_ptr)
+    // Принимает во владение память под size элементов, ранее выделенную аллокатором alloc
+    ArrayPtr(Type* raw_ptr, size_t size, const Allocator& alloc = Allocator()) noexcept
+            : alloc_(alloc)
+            , raw_ptr_(raw_ptr)
+            , size_(raw_ptr == nullptr ? 0 : size)
     {
     }
 
     ArrayPtr(const ArrayPtr&) = delete;
     ArrayPtr& operator=(const ArrayPtr&) = delete;
 
-    ArrayPtr(ArrayPtr&& other) {
-        raw_ptr_ = std::exchange(other.raw_ptr_, nullptr);
+    ArrayPtr(ArrayPtr&& other) noexcept
+            : alloc_(std::move(other.alloc_))
+            , raw_ptr_(std::exchange(other.raw_ptr_, nullptr))
+            , size_(std::exchange(other.size_, 0))
+    {
     }
 
-    ArrayPtr& operator=(ArrayPtr&& rhs) {
-        raw_ptr_ = std::exchange(rhs.raw_ptr_, nullptr);
+    // Аллокатор переходит вместе с памятью, только если это разрешает
+    // propagate_on_container_move_assignment, иначе аллокаторы должны быть равны
+    ArrayPtr& operator=(ArrayPtr&& rhs) noexcept {
+        if (this != &rhs) {
+            Deallocate();
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(rhs.alloc_);
+            }
+            raw_ptr_ = std::exchange(rhs.raw_ptr_, nullptr);
+            size_ = std::exchange(rhs.size_, 0);
+        }
         return *this;
     }
 
     ~ArrayPtr() {
-        delete[] raw_ptr_;
+        Deallocate();
+    }
+
+    // Меняет размер блока средствами аллокатора с сохранением содержимого побайтно.
+    // Доступно, если аллокатор умеет reallocate (см. detail::HasReallocate);
+    // элементы в блоке должны допускать побайтный перенос
+    void Reallocate(size_t new_size) {
+        if (raw_ptr_ == nullptr) {
+            ArrayPtr tmp(new_size, alloc_);
+            swap(tmp);
+            return;
+        }
+        raw_ptr_ = alloc_.reallocate(raw_ptr_, size_, new_size);
+        size_ = new_size;
     }
 
     // Прекращает владением массивом в памяти, возвращает значение адреса массива
     // После вызова метода указатель на массив должен обнулиться
     [[nodiscard]] Type* Release() noexcept {
+        size_ = 0;
         return std::exchange(raw_ptr_, nullptr);
     }
 
@@ -55,12 +113,39 @@ public:
         return raw_ptr_;
     }
 
-    // Обменивается значениями указателя на массив с объектом other
+    // Количество элементов, под которые выделена память
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    Allocator& GetAllocator() noexcept {
+        return alloc_;
+    }
+
+    const Allocator& GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    // Обменивается значениями указателя на массив с объектом other.
+    // Аллокаторы обмениваются, только если это разрешает propagate_on_container_swap,
+    // иначе они должны быть равны
     void swap(ArrayPtr& other) noexcept {
-        std::swap(other.raw_ptr_, raw_ptr_);
+        using std::swap;
+        if constexpr (AllocTraits::propagate_on_container_swap::value) {
+            swap(other.alloc_, alloc_);
+        }
+        swap(other.raw_ptr_, raw_ptr_);
+        swap(other.size_, size_);
     }
 
 private:
+    void Deallocate() noexcept {
+        if (raw_ptr_ != nullptr) {
+            AllocTraits::deallocate(alloc_, raw_ptr_, size_);
+        }
+    }
+
+    [[no_unique_address]] Allocator alloc_;
     Type* raw_ptr_ = nullptr;
+    size_t size_ = 0;
 };
-
@@ -0,0 +1,599 @@
+#include "flat_map.h"
+#include "gap_buffer.h"
+#include "huge_page_allocator.h"
+#include "segmented_vector.h"
+#include "simple_vector.h"
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+namespace {
+
+// Верхняя граница размера векторов; тяжёлые типы ограничиваются ещё и объёмом памяти
+#ifndef SIMPLE_VECTOR_BENCH_MAX_SIZE
+#define SIMPLE_VECTOR_BENCH_MAX_SIZE 100000000
+#endif
+
+constexpr int64_t kMinSize = 16;
+constexpr int64_t kMaxSize = SIMPLE_VECTOR_BENCH_MAX_SIZE;
+constexpr int64_t kMaxBytes = int64_t(1) << 30;
+
+struct Pod64 {
+    int64_t fields[8];
+};
+
+// Некопируемый тип, как X из main.cpp
+class X {
+public:
+    X()
+        : X(5) {
+    }
+    X(size_t num)
+        : x_(num) {
+    }
+    X(const X& other) = delete;
+    X& operator=(const X& other) = delete;
+    X(X&& other) noexcept {
+        x_ = exchange(other.x_, 0);
+    }
+    X& operator=(X&& other) noexcept {
+        x_ = exchange(other.x_, 0);
+        return *this;
+    }
+    size_t GetX() const {
+        return x_;
+    }
+
+private:
+    size_t x_;
+};
+
+template <typename Container>
+using ValueType = remove_cvref_t<decltype(*declval<Container&>().begin())>;
+
+template <typename Type>
+Type MakeValue(int64_t i);
+
+template <>
+int MakeValue<int>(int64_t i) {
+    return static_cast<int>(i);
+}
+
+template <>
+Pod64 MakeValue<Pod64>(int64_t i) {
+    return {{i, i, i, i, i, i, i, i}};
+}
+
+template <>
+string MakeValue<string>(int64_t i) {
+    // длиннее буфера малой строки, чтобы каждая строка жила в куче
+    return "benchmark-string-value-" + to_string(i);
+}
+
+template <>
+X MakeValue<X>(int64_t i) {
+    return X(static_cast<size_t>(i));
+}
+
+template <typename Type>
+int64_t ElementWeight(const Type& value) {
+    if constexpr (is_same_v<Type, int>) {
+        return value;
+    } else if constexpr (is_same_v<Type, Pod64>) {
+        return value.fields[0];
+    } else if constexpr (is_same_v<Type, string>) {
+        return static_cast<int64_t>(value.size());
+    } else {
+        return static_cast<int64_t>(value.GetX());
+    }
+}
+
+// Единый интерфейс над SimpleVector и std::vector
+template <typename Type>
+void PushBack(SimpleVector<Type>& v, Type value) {
+    v.PushBack(move(value));
+}
+
+template <typename Type>
+void PushBack(vector<Type>& v, Type value) {
+    v.push_back(move(value));
+}
+
+template <typename Type>
+void PushBack(SegmentedVector<Type>& v, Type value) {
+    v.PushBack(move(value));
+}
+
+template <typename Type>
+void PushBack(GapBuffer<Type>& v, Type value) {
+    v.PushBack(move(value));
+}
+
+template <typename Type>
+void Reserve(GapBuffer<Type>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename Type>
+void InsertAt(GapBuffer<Type>& v, size_t index, Type value) {
+    v.Insert(v.cbegin() + index, move(value));
+}
+
+template <typename Type>
+void EraseAt(GapBuffer<Type>& v, size_t index) {
+    v.Erase(v.cbegin() + index);
+}
+
+template <typename Type>
+void Reserve(SimpleVector<Type>& v, size_t capacity) {
+    v.Reserve(capacity);
+}
+
+template <typename Type>
+void Reserve(vector<Type>& v, size_t capacity) {
+    v.reserve(capacity);
+}
+
+template <typename Type>
+void InsertAt(SimpleVector<Type>& v, size_t index, Type value) {
+    v.Insert(v.begin() + index, move(value));
+}
+
+template <typename Type>
+void InsertAt(vector<Type>& v, size_t index, Type value) {
+    v.insert(v.begin() + index, move(value));
+}
+
+template <typename Type>
+void EraseAt(SimpleVector<Type>& v, size_t index) {
+    v.Erase(v.begin() + index);
+}
+
+template <typename Type>
+void EraseAt(vector<Type>& v, size_t index) {
+    v.erase(v.begin() + index);
+}
+
+template <typename Type>
+void PopBack(SimpleVector<Type>& v) {
+    v.PopBack();
+}
+
+template <typename Type>
+void PopBack(vector<Type>& v) {
+    v.pop_back();
+}
+
+template <typename Container>
+Container Generate(int64_t size) {
+    using Type = ValueType<Container>;
+    Container v;
+    Reserve(v, size);
+    for (int64_t i = 0; i < size; ++i) {
+        PushBack(v, MakeValue<Type>(i));
+    }
+    return v;
+}
+
+template <typename Container>
+void SetItems(benchmark::State& state, int64_t items_per_iteration) {
+    using Type = ValueType<Container>;
+    state.SetItemsProcessed(state.iterations() * items_per_iteration);
+    state.SetBytesProcessed(state.iterations() * items_per_iteration * static_cast<int64_t>(sizeof(Type)));
+}
+
+template <typename Container>
+void BM_PushBack(benchmark::State& state) {
+    using Type = ValueType<Container>;
+    const int64_t size = state.range(0);
+    for (auto _ : state) {
+        Container v;
+        for (int64_t i = 0; i < size; ++i) {
+            PushBack(v, MakeValue<Type>(i));
+        }
+        benchmark::DoNotOptimize(v);
+    }
+    SetItems<Container>(state, size);
+}
+
+// Худшая задержка одного PushBack: у SimpleVector это перенос всех элементов при росте,
+// у SegmentedVector - выделение очередного блока
+template <typename Container>
+void BM_PushBackLatency(benchmark::State& state) {
+    using Type = ValueType<Container>;
+    const int64_t size = state.range(0);
+    double worst_ns = 0;
+    for (auto _ : state) {
+        Container v;
+        for (int64_t i = 0; i < size; ++i) {
+            Type value = MakeValue<Type>(i);
+            const auto start = chrono::steady_clock::now();
+            PushBack(v, move(value));
+            const auto finish = chrono::steady_clock::now();
+            worst_ns = max(worst_ns, chrono::duration<double, nano>(finish - start).count());
+        }
+        benchmark::DoNotOptimize(v);
+    }
+    state.counters["worst_ns"] = worst_ns;
+    SetItems<Container>(state, size);
+}
+
+template <typename Container>
+void BM_ReservePushBack(benchmark::State& state) {
+    using Type = ValueType<Container>;
+    const int64_t size = state.range(0);
+    for (auto _ : state) {
+        Container v;
+        Reserve(v, size);
+        for (int64_t i = 0; i < size; ++i) {
+            PushBack(v, MakeValue<Type>(i));
+        }
+        benchmark::DoNotOptimize(v);
+    }
+    SetItems<Container>(state, size);
+}
+
+// Вставка с последующим PopBack сохраняет размер, так что каждая итерация сдвигает весь хвост
+template <typename Container>
+void BM_Insert(benchmark::State& state, double position) {
+    using Type = ValueType<Container>;
+    const int64_t size = state.range(0);
+    Container v = Generate<Container>(size);
+    const size_t index = static_cast<size_t>(static_cast<double>(size) * position);
+    for (auto _ : state) {
+        InsertAt(v, index, MakeValue<Type>(0));
+        PopBack(v);
+        benchmark::DoNotOptimize(v);
+    }
+    SetItems<Container>(state, size - static_cast<int64_t>(index));
+}
+
+// Вставка и удаление у курсора, который каждый раз смещается на несколько позиций,
+// как в редакторе или книге заявок
+template <typename Container>
+void BM_CursorEdit(benchmark::State& state) {
+    using Type = ValueType<Container>;
+    const int64_t size = state.range(0);
+    Container v = Generate<Container>(size);
+    int64_t cursor = size / 2;
+    uint32_t random = 1;
+    for (auto _ : state) {
+        random = random * 1664525 + 1013904223;
+        cursor = clamp<int64_t>(cursor + static_cast<int64_t>(random >> 29) - 4, 1, size - 1);
+        InsertAt(v, static_cast<size_t>(cursor), MakeValue<Type>(0));
+        EraseAt(v, static_cast<size_t>(cursor - 1));
+        benchmark::DoNotOptimize(v);
+    }
+    SetItems<Container>(state, 1);
+}
+
+template <typename Container>
+void BM_EraseFront(benchmark::State& state) {
+    using Type = ValueType<Container>;
+    const int64_t size = state.range(0);
+    Container v = Generate<Container>(size);
+    for (auto _ : state) {
+        EraseAt(v, 0);
+        PushBack(v, MakeValue<Type>(0));
+        benchmark::DoNotOptimize(v);
+    }
+    SetItems<Container>(state, size);
+}
+
+template <typename Container>
+void BM_Copy(benchmark::State& state) {
+    const int64_t size = state.range(0);
+    const Container v = Generate<Container>(size);
+    for (auto _ : state) {
+        Container copy(v);
+        benchmark::DoNotOptimize(copy);
+    }
+    SetItems<Container>(state, size);
+}
+
+template <typename Container>
+void BM_Move(benchmark::State& state) {
+    const int64_t size = state.range(0);
+    Container v = Generate<Container>(size);
+    for (auto _ : state) {
+        Container moved(move(v));
+        benchmark::DoNotOptimize(moved);
+        v = move(moved);
+    }
+    state.SetItemsProcessed(state.iterations());
+}
+
+template <typename Container>
+void BM_Iterate(benchmark::State& state) {
+    const int64_t size = state.range(0);
+    const Container v = Generate<Container>(size);
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (const auto& value : v) {
+            sum += ElementWeight(value);
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    SetItems<Container>(state, size);
+}
+
+// Сравнение и поиск: быстрые пути SimpleVector против поэлементных алгоритмов на тех же данных.
+// Различие и искомое значение стоят в самом конце, так что просматривается весь вектор
+// Поэлементное сравнение без быстрого пути: собственный цикл, чтобы std::equal не свёлся к memcmp
+template <typename Type>
+bool EqualElementwise(const SimpleVector<Type>& a, const SimpleVector<Type>& b) {
+    if (a.GetSize() != b.GetSize()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.GetSize(); ++i) {
+        if (!(a[i] == b[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+template <typename Type>
+SimpleVector<Type> GenerateKeys(int64_t size) {
+    SimpleVector<Type> v(size);
+    for (int64_t i = 0; i < size; ++i) {
+        v[i] = static_cast<Type>(i % 100 + 1);
+    }
+    return v;
+}
+
+template <typename Type>
+void BM_Equal(benchmark::State& state, bool generic) {
+    const int64_t size = state.range(0);
+    const SimpleVector<Type> a = GenerateKeys<Type>(size);
+    const SimpleVector<Type> b(a);
+    for (auto _ : state) {
+        const bool equal = generic ? EqualElementwise(a, b) : a == b;
+        benchmark::DoNotOptimize(equal);
+    }
+    SetItems<SimpleVector<Type>>(state, size);
+}
+
+template <typename Type>
+void BM_Less(benchmark::State& state, bool generic) {
+    const int64_t size = state.range(0);
+    const SimpleVector<Type> a = GenerateKeys<Type>(size);
+    SimpleVector<Type> b(a);
+    b[size - 1] = static_cast<Type>(b[size - 1] + 1);
+    for (auto _ : state) {
+        const bool less = generic ? lexicographical_compare(a.begin(), a.end(), b.begin(), b.end()) : a < b;
+        benchmark::DoNotOptimize(less);
+    }
+    SetItems<SimpleVector<Type>>(state, size);
+}
+
+template <typename Type>
+void BM_Find(benchmark::State& state, bool generic) {
+    const int64_t size = state.range(0);
+    SimpleVector<Type> v = GenerateKeys<Type>(size);
+    v[size - 1] = 0;
+    for (auto _ : state) {
+        const auto it = generic ? find(v.cbegin(), v.cend(), Type{0}) : v.Find(Type{0});
+        benchmark::DoNotOptimize(it);
+    }
+    SetItems<SimpleVector<Type>>(state, size);
+}
+
+template <typename Type>
+void BM_Count(benchmark::State& state, bool generic) {
+    const int64_t size = state.range(0);
+    const SimpleVector<Type> v = GenerateKeys<Type>(size);
+    for (auto _ : state) {
+        const size_t n = generic ? static_cast<size_t>(count(v.begin(), v.end(), Type{1})) : v.Count(Type{1});
+        benchmark::DoNotOptimize(n);
+    }
+    SetItems<SimpleVector<Type>>(state, size);
+}
+
+// Большие страницы: случайные чтения (с Prefetch и без) и последовательный проход по одному вектору
+// с обычным аллокатором и с HugePageAllocator. Память заполняется до замера, так что в замер
+// не попадают ни mmap, ни первые обращения к страницам
+constexpr int64_t kGatherLoads = int64_t(1) << 20;
+constexpr uint32_t kPrefetchDistance = 16;
+
+// Линейный конгруэнтный генератор и сведение к [0, size) умножением, без деления
+inline uint32_t NextRandom(uint32_t& seed) {
+    seed = seed * 1664525u + 1013904223u;
+    return seed;
+}
+
+inline size_t RandomIndex(uint32_t& seed, size_t size) {
+    return static_cast<size_t>((static_cast<uint64_t>(NextRandom(seed)) * size) >> 32);
+}
+
+template <typename Allocator>
+SimpleVector<int64_t, Allocator> GenerateWide(int64_t size) {
+    SimpleVector<int64_t, Allocator> v(size);
+    for (int64_t i = 0; i < size; ++i) {
+        v[i] = i;
+    }
+    return v;
+}
+
+template <typename Allocator>
+void BM_Gather(benchmark::State& state, bool prefetch) {
+    const size_t size = state.range(0);
+    const SimpleVector<int64_t, Allocator> v = GenerateWide<Allocator>(size);
+    for (auto _ : state) {
+        // ahead идёт той же последовательностью на kPrefetchDistance шагов впереди
+        uint32_t current = 1;
+        uint32_t ahead = current;
+        for (uint32_t i = 0; i < kPrefetchDistance; ++i) {
+            NextRandom(ahead);
+        }
+        int64_t sum = 0;
+        for (int64_t i = 0; i < kGatherLoads; ++i) {
+            if (prefetch) {
+                v.Prefetch(RandomIndex(ahead, size));
+            }
+            sum += v[RandomIndex(current, size)];
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * kGatherLoads);
+}
+
+template <typename Allocator>
+void BM_Stream(benchmark::State& state) {
+    const int64_t size = state.range(0);
+    const SimpleVector<int64_t, Allocator> v = GenerateWide<Allocator>(size);
+    for (auto _ : state) {
+        int64_t sum = 0;
+        for (const int64_t value : v) {
+            sum += value;
+        }
+        benchmark::DoNotOptimize(sum);
+    }
+    state.SetItemsProcessed(state.iterations() * size);
+    state.SetBytesProcessed(state.iterations() * size * static_cast<int64_t>(sizeof(int64_t)));
+}
+
+// Поиск в словаре из size чётных ключей по случайным ключам, половина из которых отсутствует
+template <typename Map>
+void BM_Lookup(benchmark::State& state) {
+    const int64_t size = state.range(0);
+    Map map;
+    for (int64_t i = 0; i < size; ++i) {
+        map.Insert({2 * i, i});
+    }
+    constexpr int64_t kLookups = 4096;
+    for (auto _ : state) {
+        uint32_t seed = 1;
+        int64_t found = 0;
+        for (int64_t i = 0; i < kLookups; ++i) {
+            found += map.Contains(static_cast<int64_t>(RandomIndex(seed, 2 * size)));
+        }
+        benchmark::DoNotOptimize(found);
+    }
+    state.SetItemsProcessed(state.iterations() * kLookups);
+}
+
+// Обёртка, дающая std::map тот же интерфейс, что у FlatMap
+class StdMap {
+public:
+    void Insert(const pair<int64_t, int64_t>& item) {
+        map_.insert(item);
+    }
+
+    bool Contains(int64_t key) const {
+        return map_.find(key) != map_.end();
+    }
+
+private:
+    map<int64_t, int64_t> map_;
+};
+
+template <typename Type>
+void ApplySizes(benchmark::internal::Benchmark* b) {
+    const int64_t max_size = min(kMaxSize, kMaxBytes / static_cast<int64_t>(sizeof(Type)));
+    b->RangeMultiplier(16)->Range(kMinSize, max(kMinSize, max_size));
+}
+
+template <typename Container>
+void RegisterContainer(const string& container_name, const string& type_name) {
+    using Type = ValueType<Container>;
+    const string suffix = "/" + container_name + "/" + type_name;
+
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("PushBack" + suffix).c_str(), BM_PushBack<Container>));
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("ReservePushBack" + suffix).c_str(), BM_ReservePushBack<Container>));
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("InsertFront" + suffix).c_str(), BM_Insert<Container>, 0.0));
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("InsertMiddle" + suffix).c_str(), BM_Insert<Container>, 0.5));
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("EraseFront" + suffix).c_str(), BM_EraseFront<Container>));
+    if constexpr (is_copy_constructible_v<Type>) {
+        ApplySizes<Type>(benchmark::RegisterBenchmark(("Copy" + suffix).c_str(), BM_Copy<Container>));
+    }
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("Move" + suffix).c_str(), BM_Move<Container>));
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("Iterate" + suffix).c_str(), BM_Iterate<Container>));
+}
+
+template <typename Type>
+void RegisterSearch(const string& type_name) {
+    for (const bool generic : {false, true}) {
+        const string suffix = string(generic ? "/Generic/" : "/SimpleVector/") + type_name;
+        ApplySizes<Type>(benchmark::RegisterBenchmark(("Equal" + suffix).c_str(), BM_Equal<Type>, generic));
+        ApplySizes<Type>(benchmark::RegisterBenchmark(("Less" + suffix).c_str(), BM_Less<Type>, generic));
+        ApplySizes<Type>(benchmark::RegisterBenchmark(("Find" + suffix).c_str(), BM_Find<Type>, generic));
+        ApplySizes<Type>(benchmark::RegisterBenchmark(("Count" + suffix).c_str(), BM_Count<Type>, generic));
+    }
+}
+
+template <typename Type>
+void RegisterLatency(const string& type_name) {
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("PushBackLatency/SimpleVector/" + type_name).c_str(),
+                                                  BM_PushBackLatency<SimpleVector<Type>>));
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("PushBackLatency/SegmentedVector/" + type_name).c_str(),
+                                                  BM_PushBackLatency<SegmentedVector<Type>>));
+}
+
+template <typename Type>
+void RegisterCursorEdit(const string& type_name) {
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("CursorEdit/SimpleVector/" + type_name).c_str(),
+                                                  BM_CursorEdit<SimpleVector<Type>>));
+    ApplySizes<Type>(benchmark::RegisterBenchmark(("CursorEdit/GapBuffer/" + type_name).c_str(),
+                                                  BM_CursorEdit<GapBuffer<Type>>));
+}
+
+template <typename Allocator>
+void RegisterPages(const string& allocator_name) {
+    const string suffix = "/" + allocator_name + "/int64_t";
+    ApplySizes<int64_t>(benchmark::RegisterBenchmark(("Gather" + suffix).c_str(), BM_Gather<Allocator>, false));
+    ApplySizes<int64_t>(benchmark::RegisterBenchmark(("GatherPrefetch" + suffix).c_str(), BM_Gather<Allocator>, true));
+    ApplySizes<int64_t>(benchmark::RegisterBenchmark(("Stream" + suffix).c_str(), BM_Stream<Allocator>));
+}
+
+void RegisterLookup() {
+    constexpr int64_t kMaxMapSize = int64_t(1) << 20;
+    benchmark::RegisterBenchmark("Lookup/FlatMap/int64_t", BM_Lookup<FlatMap<int64_t, int64_t>>)
+            ->RangeMultiplier(16)
+            ->Range(kMinSize, kMaxMapSize);
+    benchmark::RegisterBenchmark("Lookup/std::map/int64_t", BM_Lookup<StdMap>)
+            ->RangeMultiplier(16)
+            ->Range(kMinSize, kMaxMapSize);
+}
+
+template <typename Type>
+void RegisterType(const string& type_name) {
+    RegisterContainer<SimpleVector<Type>>("SimpleVector", type_name);
+    RegisterContainer<vector<Type>>("std::vector", type_name);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+    RegisterType<int>("int");
+    RegisterType<Pod64>("Pod64");
+    RegisterType<string>("string");
+    RegisterType<X>("X");
+    RegisterSearch<uint8_t>("uint8_t");
+    RegisterSearch<int32_t>("int32_t");
+    RegisterLatency<int>("int");
+    RegisterLatency<Pod64>("Pod64");
+    RegisterCursorEdit<int>("int");
+    RegisterCursorEdit<string>("string");
+    RegisterPages<allocator<int64_t>>("Default");
+    RegisterPages<HugePageAllocator<int64_t>>("HugePages");
+    RegisterLookup();
+
+    benchmark::Initialize(&argc, argv);
+    if (benchmark::ReportUnrecognizedArguments(argc, argv)) {
+        return 1;
+    }
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return 0;
+}
@@ -0,0 +1,205 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <type_traits>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+// Сравнение и поиск по непрерывным диапазонам. Для целых типов равенство совпадает с побайтовым,
+// поэтому работают memcmp/memchr и SSE2-сравнение блоками по 16 байт; остальные типы идут
+// через обычные алгоритмы. Числа с плавающей точкой побайтно сравнивать нельзя (NaN, -0.0)
+namespace detail {
+
+template <typename Type>
+inline constexpr bool kBitwiseComparable = std::is_integral_v<Type>;
+
+// Для этих типов порядок memcmp совпадает с порядком operator<
+template <typename Type>
+inline constexpr bool kMemcmpOrdered = kBitwiseComparable<Type> && std::is_unsigned_v<Type> && sizeof(Type) == 1;
+
+#ifdef __SSE2__
+
+inline constexpr size_t kSimdBytes = sizeof(__m128i);
+
+template <typename Type>
+__m128i Broadcast(Type value) noexcept {
+    if constexpr (sizeof(Type) == 1) {
+        return _mm_set1_epi8(static_cast<char>(value));
+    } else if constexpr (sizeof(Type) == 2) {
+        return _mm_set1_epi16(static_cast<short>(value));
+    } else {
+        return _mm_set1_epi32(static_cast<int>(value));
+    }
+}
+
+// Сравнивает блок из 16 байт с needle: в каждом совпавшем элементе все биты единичные
+template <typename Type>
+__m128i EqualLanes(const Type* block, __m128i needle) noexcept {
+    const __m128i items = _mm_loadu_si128(reinterpret_cast<const __m128i*>(block));
+    if constexpr (sizeof(Type) == 1) {
+        return _mm_cmpeq_epi8(items, needle);
+    } else if constexpr (sizeof(Type) == 2) {
+        return _mm_cmpeq_epi16(items, needle);
+    } else {
+        return _mm_cmpeq_epi32(items, needle);
+    }
+}
+
+// Маска байтов блока, принадлежащих элементам, равным needle
+template <typename Type>
+unsigned EqualByteMask(const Type* block, __m128i needle) noexcept {
+    return static_cast<unsigned>(_mm_movemask_epi8(EqualLanes(block, needle)));
+}
+
+// Совпавший элемент равен -1, поэтому вычитание увеличивает счётчик его позиции на единицу
+template <typename Type>
+__m128i SubtractLanes(__m128i acc, __m128i lanes) noexcept {
+    if constexpr (sizeof(Type) == 1) {
+        return _mm_sub_epi8(acc, lanes);
+    } else if constexpr (sizeof(Type) == 2) {
+        return _mm_sub_epi16(acc, lanes);
+    } else {
+        return _mm_sub_epi32(acc, lanes);
+    }
+}
+
+template <typename Type>
+size_t SumLanes(__m128i acc) noexcept {
+    using Lane = std::conditional_t<sizeof(Type) == 1, std::uint8_t,
+                                    std::conditional_t<sizeof(Type) == 2, std::uint16_t, std::uint32_t>>;
+    alignas(kSimdBytes) Lane lanes[kSimdBytes / sizeof(Type)];
+    _mm_store_si128(reinterpret_cast<__m128i*>(lanes), acc);
+    size_t sum = 0;
+    for (const Lane lane : lanes) {
+        sum += lane;
+    }
+    return sum;
+}
+
+template <typename Type>
+inline constexpr bool kSimdSearchable = kBitwiseComparable<Type> && sizeof(Type) <= 4;
+
+#endif
+
+template <typename Type>
+bool EqualRanges(const Type* lhs, const Type* rhs, size_t size) {
+    if constexpr (kBitwiseComparable<Type>) {
+        return size == 0 || std::memcmp(lhs, rhs, size * sizeof(Type)) == 0;
+    } else {
+        return std::equal(lhs, lhs + size, rhs);
+    }
+}
+
+// Индекс первого различающегося элемента двух побайтно сравнимых диапазонов или size
+template <typename Type>
+size_t MismatchIndex(const Type* lhs, const Type* rhs, size_t size) noexcept {
+    static_assert(kBitwiseComparable<Type>);
+    const auto* a = reinterpret_cast<const unsigned char*>(lhs);
+    const auto* b = reinterpret_cast<const unsigned char*>(rhs);
+    const size_t bytes = size * sizeof(Type);
+    size_t i = 0;
+#ifdef __SSE2__
+    for (; i + kSimdBytes <= bytes; i += kSimdBytes) {
+        const __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i));
+        const __m128i y = _mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i));
+        const unsigned equal = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y)));
+        if (equal != 0xFFFF) {
+            return (i + std::countr_zero(~equal)) / sizeof(Type);
+        }
+    }
+#endif
+    for (; i < bytes; ++i) {
+        if (a[i] != b[i]) {
+            return i / sizeof(Type);
+        }
+    }
+    return size;
+}
+
+template <typename Type>
+bool LessRanges(const Type* lhs, size_t lhs_size, const Type* rhs, size_t rhs_size) {
+    if constexpr (kBitwiseComparable<Type>) {
+        const size_t common = std::min(lhs_size, rhs_size);
+        if constexpr (kMemcmpOrdered<Type>) {
+            const int order = common == 0 ? 0 : std::memcmp(lhs, rhs, common);
+            if (order != 0) {
+                return order < 0;
+            }
+        } else {
+            const size_t i = MismatchIndex(lhs, rhs, common);
+            if (i != common) {
+                return lhs[i] < rhs[i];
+            }
+        }
+        return lhs_size < rhs_size;
+    } else {
+        return std::lexicographical_compare(lhs, lhs + lhs_size, rhs, rhs + rhs_size);
+    }
+}
+
+// Индекс первого элемента, равного value, или size
+template <typename Type>
+size_t FindIndex(const Type* data, size_t size, const Type& value) {
+    if constexpr (kBitwiseComparable<Type> && sizeof(Type) == 1) {
+        const void* found = size == 0 ? nullptr : std::memchr(data, static_cast<unsigned char>(value), size);
+        return found == nullptr ? size : static_cast<const Type*>(found) - data;
+    }
+#ifdef __SSE2__
+    else if constexpr (kSimdSearchable<Type>) {
+        constexpr size_t kLanes = kSimdBytes / sizeof(Type);
+        const __m128i needle = Broadcast(value);
+        size_t i = 0;
+        for (; i + kLanes <= size; i += kLanes) {
+            const unsigned mask = EqualByteMask(data + i, needle);
+            if (mask != 0) {
+                return i + std::countr_zero(mask) / sizeof(Type);
+            }
+        }
+        for (; i < size; ++i) {
+            if (data[i] == value) {
+                return i;
+            }
+        }
+        return size;
+    }
+#endif
+    else {
+        return std::find(data, data + size, value) - data;
+    }
+}
+
+template <typename Type>
+size_t CountEqual(const Type* data, size_t size, const Type& value) {
+#ifdef __SSE2__
+    if constexpr (kSimdSearchable<Type>) {
+        constexpr size_t kLanes = kSimdBytes / sizeof(Type);
+        const __m128i needle = Broadcast(value);
+        // счётчики в позициях элементов; 8-битные переполняются после 255 блоков
+        constexpr size_t kMaxBlocks = 255;
+        size_t count = 0;
+        size_t i = 0;
+        while (i + kLanes <= size) {
+            __m128i acc = _mm_setzero_si128();
+            for (size_t block = 0; block < kMaxBlocks && i + kLanes <= size; ++block, i += kLanes) {
+                acc = SubtractLanes<Type>(acc, EqualLanes(data + i, needle));
+            }
+            count += SumLanes<Type>(acc);
+        }
+        for (; i < size; ++i) {
+            count += data[i] == value;
+        }
+        return count;
+    } else
+#endif
+    {
+        return std::count(data, data + size, value);
+    }
+}
+
+}  // namespace detail
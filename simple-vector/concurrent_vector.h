@@ -0,0 +1,237 @@
+#pragma once
+
+#include <atomic>
+#include <bit>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "memory_utils.h"
+#include "simple_vector.h"
+
+// Вектор, в который можно одновременно добавлять элементы из многих потоков.
+// Индекс нового элемента выдаёт один fetch_add, поэтому добавление не ждёт других потоков
+// (блокировок нет; новый кусок памяти выделяется без блокировок одним из потоков, которым он нужен).
+// Память состоит из кусков, каждый вдвое больше предыдущего, и никогда не перемещается:
+// ссылки на элементы остаются действительными до Freeze, Clear или разрушения вектора.
+//
+// У каждого слота есть флаг готовности, а счётчик опубликованных элементов продвигается по порядку
+// тем потоком, который закончил добавление: элементы с индексами меньше GetSize() сконструированы
+// и видны любому потоку. Freeze, Clear и разрушение вызываются, когда добавления закончены
+template <typename Type>
+class ConcurrentSimpleVector {
+    // элемент конструируется до выдачи индекса и переносится в свой слот без исключений,
+    // поэтому в выданных слотах не бывает дыр из-за конструктора
+    static_assert(std::is_nothrow_move_constructible_v<Type>, "elements must be nothrow move constructible");
+
+public:
+    ConcurrentSimpleVector() noexcept = default;
+
+    ConcurrentSimpleVector(const ConcurrentSimpleVector&) = delete;
+    ConcurrentSimpleVector& operator=(const ConcurrentSimpleVector&) = delete;
+
+    ~ConcurrentSimpleVector() {
+        Clear();
+    }
+
+    // Число опубликованных элементов: все добавления с меньшими индексами завершены.
+    // Если кусок не удалось выделить, счётчик останавливается на его начале
+    size_t GetSize() const noexcept {
+        return committed_.load(std::memory_order_acquire);
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < GetSize());
+        return *Slot(index);
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return *Slot(index);
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Безопасно вызывать из нескольких потоков одновременно
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        Type value(std::forward<Args>(args)...);
+        const size_t index = size_.fetch_add(1, std::memory_order_acq_rel);
+        Type* const slot = AcquireSegment(SegmentOf(index)) + OffsetIn(index);
+        Type& item = *::new (static_cast<void*>(slot)) Type(std::move(value));
+        Publish(index);
+        return item;
+    }
+
+    // Переносит элементы в непрерывный SimpleVector в порядке индексов и очищает этот вектор
+    SimpleVector<Type> Freeze() {
+        const size_t size = size_.load(std::memory_order_acquire);
+        size_t count = 0;
+        ForEachSegment(size, [&](size_t, Type*, size_t length) {
+            count += length;
+        });
+        SimpleVector<Type> result = SimpleVector<Type>::FromUninitialized(count, [&](Type* data, size_t) {
+            ForEachSegment(size, [&](size_t, Type* segment, size_t length) {
+                if constexpr (IsTriviallyRelocatable<Type>::value) {
+                    detail::RelocateBitwise(segment, length, data);
+                } else {
+                    std::uninitialized_move_n(segment, length, data);
+                    std::destroy_n(segment, length);
+                }
+                data += length;
+            });
+        });
+        ReleaseSegments();
+        return result;
+    }
+
+    void Clear() noexcept {
+        ForEachSegment(size_.load(std::memory_order_acquire), [](size_t, Type* segment, size_t length) {
+            std::destroy_n(segment, length);
+        });
+        ReleaseSegments();
+    }
+
+private:
+    static constexpr size_t kFirstSegmentBits = 5;
+    static constexpr size_t kFirstSegmentSize = size_t(1) << kFirstSegmentBits;
+    // кусок k хранит индексы [kFirstSegmentSize * (2^k - 1), kFirstSegmentSize * (2^(k+1) - 1))
+    static constexpr size_t kSegmentCount = sizeof(size_t) * 8 - kFirstSegmentBits;
+
+    // за SegmentSize(k) элементами куска k лежат флаги готовности его слотов
+    std::atomic<Type*> segments_[kSegmentCount] = {};
+    // число выданных индексов, включая ещё не завершённые добавления
+    std::atomic<size_t> size_ = 0;
+    // длина готового префикса
+    std::atomic<size_t> committed_ = 0;
+
+    // Метка куска, память под который выделить не удалось: его слоты потеряны,
+    // и добавления, попавшие в него, бросают std::bad_alloc
+    alignas(Type) static inline unsigned char lost_segment_[sizeof(Type)];
+
+    static Type* LostSegment() noexcept {
+        return reinterpret_cast<Type*>(lost_segment_);
+    }
+
+    static size_t SegmentOf(size_t index) noexcept {
+        return std::bit_width(index / kFirstSegmentSize + 1) - 1;
+    }
+
+    static size_t SegmentBegin(size_t segment) noexcept {
+        return kFirstSegmentSize * ((size_t(1) << segment) - 1);
+    }
+
+    static size_t SegmentSize(size_t segment) noexcept {
+        return kFirstSegmentSize << segment;
+    }
+
+    static size_t OffsetIn(size_t index) noexcept {
+        return index - SegmentBegin(SegmentOf(index));
+    }
+
+    // Размер блока куска в элементах Type вместе с флагами готовности
+    static size_t BlockSize(size_t segment) noexcept {
+        const size_t flag_bytes = SegmentSize(segment) * sizeof(std::atomic<bool>);
+        return SegmentSize(segment) + (flag_bytes + sizeof(Type) - 1) / sizeof(Type);
+    }
+
+    static std::atomic<bool>* ReadyFlags(Type* data, size_t segment) noexcept {
+        return reinterpret_cast<std::atomic<bool>*>(data + SegmentSize(segment));
+    }
+
+    // Слот index сконструирован; кусок ещё может быть не выделен
+    bool IsReady(size_t index) const noexcept {
+        if (index >= size_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        const size_t segment = SegmentOf(index);
+        Type* const data = segments_[segment].load(std::memory_order_acquire);
+        return data != nullptr && data != LostSegment() && ReadyFlags(data, segment)[OffsetIn(index)].load();
+    }
+
+    // Отмечает слот готовым и продвигает счётчик по всем готовым слотам за ним. Флаг и счётчик
+    // меняются и читаются seq_cst: из двух потоков, закончивших соседние слоты, хотя бы один
+    // увидит готовность другого, поэтому префикс не застревает
+    void Publish(size_t index) noexcept {
+        const size_t segment = SegmentOf(index);
+        ReadyFlags(segments_[segment].load(std::memory_order_acquire), segment)[OffsetIn(index)].store(true);
+        size_t committed = committed_.load();
+        while (IsReady(committed)) {
+            if (committed_.compare_exchange_weak(committed, committed + 1)) {
+                ++committed;
+            }
+        }
+    }
+
+    Type* Slot(size_t index) const noexcept {
+        return segments_[SegmentOf(index)].load(std::memory_order_acquire) + OffsetIn(index);
+    }
+
+    // Возвращает кусок, при необходимости выделяя его. Если несколько потоков выделили кусок одновременно,
+    // остаётся первый установленный, а остальные возвращают свою память
+    Type* AcquireSegment(size_t segment) {
+        Type* current = segments_[segment].load(std::memory_order_acquire);
+        if (current == nullptr) {
+            Type* fresh = nullptr;
+            try {
+                fresh = std::allocator<Type>().allocate(BlockSize(segment));
+            } catch (...) {
+                // слот уже выдан, поэтому кусок либо появится у другого потока, либо будет помечен потерянным
+                if (segments_[segment].compare_exchange_strong(current, LostSegment(), std::memory_order_acq_rel)) {
+                    throw;
+                }
+            }
+            if (fresh != nullptr) {
+                std::atomic<bool>* const flags = ReadyFlags(fresh, segment);
+                for (size_t i = 0; i < SegmentSize(segment); ++i) {
+                    ::new (static_cast<void*>(flags + i)) std::atomic<bool>(false);
+                }
+                if (segments_[segment].compare_exchange_strong(current, fresh, std::memory_order_acq_rel)) {
+                    return fresh;
+                }
+                std::allocator<Type>().deallocate(fresh, BlockSize(segment));
+            }
+        }
+        if (current == LostSegment()) {
+            throw std::bad_alloc();
+        }
+        return current;
+    }
+
+    // Вызывает func(segment, data, length) для заполненной части каждого выделенного куска
+    template <typename Func>
+    void ForEachSegment(size_t size, Func&& func) const {
+        for (size_t segment = 0; segment < kSegmentCount && SegmentBegin(segment) < size; ++segment) {
+            Type* const data = segments_[segment].load(std::memory_order_acquire);
+            if (data != nullptr && data != LostSegment()) {
+                func(segment, data, std::min(size - SegmentBegin(segment), SegmentSize(segment)));
+            }
+        }
+    }
+
+    void ReleaseSegments() noexcept {
+        for (size_t segment = 0; segment < kSegmentCount; ++segment) {
+            Type* const data = segments_[segment].exchange(nullptr, std::memory_order_acq_rel);
+            if (data != nullptr && data != LostSegment()) {
+                std::allocator<Type>().deallocate(data, BlockSize(segment));
+            }
+        }
+        size_.store(0, std::memory_order_release);
+        committed_.store(0, std::memory_order_release);
+    }
+};
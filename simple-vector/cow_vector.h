@@ -0,0 +1,256 @@
+#pragma once
+
+#include <atomic>
+#include <cstdlib>
+#include <initializer_list>
+#include <stdexcept>
+#include <cassert>
+#include <utility>
+
+#include "simple_vector.h"
+
+// SimpleVector с копированием при записи: копия объекта только увеличивает счётчик ссылок
+// на общий буфер, а буфер клонируется при первом изменении через копию, которая его делит.
+// Неконстантные operator[], At, begin и end тоже считаются изменением; для чтения без клонирования
+// используйте константный объект, cbegin/cend или Read(). Буфер, на элементы которого выдана
+// изменяемая ссылка или итератор, больше не делится: копии такого объекта сразу получают свой буфер.
+// Разные объекты, делящие буфер, можно копировать, читать и изменять из разных потоков
+template <typename Type>
+class CowSimpleVector {
+public:
+    using Iterator = typename SimpleVector<Type>::Iterator;
+    using ConstIterator = typename SimpleVector<Type>::ConstIterator;
+
+    CowSimpleVector() noexcept = default;
+
+    explicit CowSimpleVector(size_t size)
+            : storage_(new Storage{SimpleVector<Type>(size)})
+    {
+    }
+
+    CowSimpleVector(size_t size, const Type& value)
+            : storage_(new Storage{SimpleVector<Type>(size, value)})
+    {
+    }
+
+    CowSimpleVector(std::initializer_list<Type> init)
+            : storage_(new Storage{SimpleVector<Type>(init)})
+    {
+    }
+
+    // Забирает элементы вектора без копирования
+    explicit CowSimpleVector(SimpleVector<Type>&& items)
+            : storage_(new Storage{std::move(items)})
+    {
+    }
+
+    CowSimpleVector(const CowSimpleVector& other)
+            : storage_(other.storage_)
+    {
+        if (storage_ == nullptr) {
+            return;
+        }
+        if (storage_->unshareable) {
+            // выданные ссылки продолжают менять буфер other, поэтому копия его не делит
+            storage_ = new Storage{SimpleVector<Type>(other.storage_->items)};
+        } else {
+            storage_->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CowSimpleVector& operator=(const CowSimpleVector& rhs) {
+        CowSimpleVector tmp(rhs);
+        swap(tmp);
+        return *this;
+    }
+
+    CowSimpleVector(CowSimpleVector&& other) noexcept
+            : storage_(std::exchange(other.storage_, nullptr))
+    {
+    }
+
+    CowSimpleVector& operator=(CowSimpleVector&& rhs) noexcept {
+        CowSimpleVector tmp(std::move(rhs));
+        swap(tmp);
+        return *this;
+    }
+
+    ~CowSimpleVector() {
+        Release();
+    }
+
+    size_t GetSize() const noexcept {
+        return storage_ == nullptr ? 0 : storage_->items.GetSize();
+    }
+
+    size_t GetCapacity() const noexcept {
+        return storage_ == nullptr ? 0 : storage_->items.GetCapacity();
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    // Буфер делят несколько объектов, и следующее изменение его склонирует
+    bool IsShared() const noexcept {
+        return storage_ != nullptr && storage_->refs.load(std::memory_order_acquire) > 1;
+    }
+
+    // Содержимое для чтения; ссылка действительна до изменения или разрушения этого объекта
+    const SimpleVector<Type>& Read() const noexcept {
+        return storage_ == nullptr ? kEmpty : storage_->items;
+    }
+
+    // Содержимое для изменения: буфер становится собственным, если его кто-то делит,
+    // и больше не делится с копиями этого объекта
+    SimpleVector<Type>& Mutable() {
+        SimpleVector<Type>& items = Own();
+        storage_->unshareable = true;
+        return items;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return Read()[index];
+    }
+
+    Type& operator[](size_t index) {
+        assert(index < GetSize());
+        return Mutable()[index];
+    }
+
+    const Type& At(size_t index) const {
+        return Read().At(index);
+    }
+
+    Type& At(size_t index) {
+        if (index >= GetSize()) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return Mutable()[index];
+    }
+
+    ConstIterator begin() const noexcept {
+        return Read().begin();
+    }
+
+    ConstIterator end() const noexcept {
+        return Read().end();
+    }
+
+    Iterator begin() {
+        return Mutable().begin();
+    }
+
+    Iterator end() {
+        return Mutable().end();
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    void PushBack(const Type& item) {
+        Own().PushBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        Own().PushBack(std::move(item));
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        return Mutable().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PopBack() {
+        Own().PopBack();
+    }
+
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        const size_t index = pos - cbegin();
+        SimpleVector<Type>& items = Mutable();
+        return items.Insert(items.begin() + index, value);
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        const size_t index = pos - cbegin();
+        SimpleVector<Type>& items = Mutable();
+        return items.Erase(items.begin() + index);
+    }
+
+    void Resize(size_t new_size) {
+        Own().Resize(new_size);
+    }
+
+    void Reserve(size_t new_capacity) {
+        Own().Reserve(new_capacity);
+    }
+
+    // Общий буфер не клонируется: объект просто отпускает его
+    void Clear() noexcept {
+        if (IsShared()) {
+            Release();
+        } else if (storage_ != nullptr) {
+            storage_->items.Clear();
+        }
+    }
+
+    void swap(CowSimpleVector& other) noexcept {
+        std::swap(storage_, other.storage_);
+    }
+
+private:
+    struct Storage {
+        SimpleVector<Type> items;
+        std::atomic<size_t> refs = 1;
+        // на элементы выданы изменяемые ссылки; меняется только единственным владельцем
+        bool unshareable = false;
+    };
+
+    static inline const SimpleVector<Type> kEmpty;
+
+    Storage* storage_ = nullptr;
+
+    SimpleVector<Type>& Own() {
+        Detach();
+        return storage_->items;
+    }
+
+    void Detach() {
+        if (storage_ == nullptr) {
+            storage_ = new Storage{};
+        } else if (IsShared()) {
+            Storage* const copy = new Storage{SimpleVector<Type>(storage_->items)};
+            Release();
+            storage_ = copy;
+        }
+    }
+
+    void Release() noexcept {
+        // acq_rel: последний владелец должен увидеть все чтения и записи остальных до удаления
+        if (storage_ != nullptr && storage_->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete storage_;
+        }
+        storage_ = nullptr;
+    }
+};
+
+template <typename Type>
+bool operator==(const CowSimpleVector<Type>& lhs, const CowSimpleVector<Type>& rhs) {
+    return lhs.Read() == rhs.Read();
+}
+
+template <typename Type>
+bool operator!=(const CowSimpleVector<Type>& lhs, const CowSimpleVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type>
+bool operator<(const CowSimpleVector<Type>& lhs, const CowSimpleVector<Type>& rhs) {
+    return lhs.Read() < rhs.Read();
+}
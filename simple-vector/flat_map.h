@@ -0,0 +1,474 @@
+#pragma once
+
+#include <cstdlib>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+#include <compare>
+#include <functional>
+#include <memory>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+
+#include "flat_set.h"
+#include "simple_vector.h"
+
+// Упорядоченный словарь на двух SimpleVector: отсортированные ключи отдельно от значений, так что
+// двоичный поиск без ветвлений читает только плотный массив ключей. Элемент при обходе -
+// пара ссылок (ключ, значение). Insert и Erase сдвигают хвосты обоих столбцов; пачку элементов
+// выгоднее добавлять через InsertSorted. Итераторы становятся недействительными при любом изменении
+template <typename Key, typename Value, typename Compare = std::less<Key>,
+          typename KeyAllocator = std::allocator<Key>, typename ValueAllocator = std::allocator<Value>>
+class FlatMap {
+    template <bool Const>
+    class BasicIterator;
+
+public:
+    using KeyContainer = SimpleVector<Key, KeyAllocator>;
+    using ValueContainer = SimpleVector<Value, ValueAllocator>;
+    using ValueType = std::pair<Key, Value>;
+    using Reference = std::pair<const Key&, Value&>;
+    using ConstReference = std::pair<const Key&, const Value&>;
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    FlatMap() = default;
+
+    explicit FlatMap(const Compare& comp)
+            : comp_(comp)
+    {
+    }
+
+    // При повторах ключа остаётся первый элемент, как при поочерёдной вставке
+    FlatMap(std::initializer_list<ValueType> init, const Compare& comp = Compare())
+            : comp_(comp)
+    {
+        keys_.Reserve(init.size());
+        values_.Reserve(init.size());
+        for (const ValueType& item : init) {
+            keys_.PushBack(item.first);
+            values_.PushBack(item.second);
+        }
+        SortByKey();
+    }
+
+    // Забирает столбцы одинакового размера в любом порядке и сортирует их по ключам
+    FlatMap(KeyContainer keys, ValueContainer values, const Compare& comp = Compare())
+            : keys_(std::move(keys))
+            , values_(std::move(values))
+            , comp_(comp)
+    {
+        if (keys_.GetSize() != values_.GetSize()) {
+            throw std::invalid_argument("FlatMap: keys and values differ in size");
+        }
+        SortByKey();
+    }
+
+    size_t GetSize() const noexcept {
+        return keys_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return keys_.IsEmpty();
+    }
+
+    const KeyContainer& Keys() const noexcept {
+        return keys_;
+    }
+
+    const ValueContainer& Values() const noexcept {
+        return values_;
+    }
+
+    Iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    Iterator end() noexcept {
+        return {this, GetSize()};
+    }
+
+    ConstIterator begin() const noexcept {
+        return {this, 0};
+    }
+
+    ConstIterator end() const noexcept {
+        return {this, GetSize()};
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    Iterator LowerBound(const Key& key) {
+        return {this, LowerIndex(key)};
+    }
+
+    ConstIterator LowerBound(const Key& key) const {
+        return {this, LowerIndex(key)};
+    }
+
+    Iterator UpperBound(const Key& key) {
+        return {this, detail::BranchlessUpperBound(keys_.Data(), keys_.GetSize(), key, comp_)};
+    }
+
+    ConstIterator UpperBound(const Key& key) const {
+        return {this, detail::BranchlessUpperBound(keys_.Data(), keys_.GetSize(), key, comp_)};
+    }
+
+    Iterator Find(const Key& key) {
+        return {this, IndexOf(key)};
+    }
+
+    ConstIterator Find(const Key& key) const {
+        return {this, IndexOf(key)};
+    }
+
+    bool Contains(const Key& key) const {
+        return IndexOf(key) != GetSize();
+    }
+
+    size_t Count(const Key& key) const {
+        return Contains(key) ? 1 : 0;
+    }
+
+    Value& At(const Key& key) {
+        return values_[CheckedIndexOf(key)];
+    }
+
+    const Value& At(const Key& key) const {
+        return values_[CheckedIndexOf(key)];
+    }
+
+    // Значение по ключу; если ключа нет, вставляет значение по умолчанию
+    Value& operator[](const Key& key) {
+        return values_[TryEmplaceIndex(key).first];
+    }
+
+    Value& operator[](Key&& key) {
+        return values_[TryEmplaceIndex(std::move(key)).first];
+    }
+
+    // Создаёт значение из args, только если ключа ещё нет. Возвращает позицию ключа и признак вставки
+    template <typename... Args>
+    std::pair<Iterator, bool> TryEmplace(const Key& key, Args&&... args) {
+        const auto [index, inserted] = TryEmplaceIndex(key, std::forward<Args>(args)...);
+        return {Iterator(this, index), inserted};
+    }
+
+    template <typename... Args>
+    std::pair<Iterator, bool> TryEmplace(Key&& key, Args&&... args) {
+        const auto [index, inserted] = TryEmplaceIndex(std::move(key), std::forward<Args>(args)...);
+        return {Iterator(this, index), inserted};
+    }
+
+    std::pair<Iterator, bool> Insert(const ValueType& item) {
+        return TryEmplace(item.first, item.second);
+    }
+
+    std::pair<Iterator, bool> Insert(ValueType&& item) {
+        return TryEmplace(std::move(item.first), std::move(item.second));
+    }
+
+    // Вставляет или перезаписывает значение ключа
+    template <typename V>
+    std::pair<Iterator, bool> InsertOrAssign(const Key& key, V&& value) {
+        const auto [index, inserted] = TryEmplaceIndex(key, std::forward<V>(value));
+        if (!inserted) {
+            values_[index] = std::forward<V>(value);
+        }
+        return {Iterator(this, index), inserted};
+    }
+
+    // Добавляет элементы отсортированного по ключам диапазона [first, last) - пар с полями first и second.
+    // Повторы внутри диапазона и уже имеющиеся ключи пропускаются. Если диапазон целиком больше
+    // словаря, столбцы дописываются в конец вставкой диапазона; иначе ключи не меньше первого
+    // из диапазона сливаются с ним за один проход без поэлементных сдвигов
+    template <typename InputIt>
+    void InsertSorted(InputIt first, InputIt last) {
+        // диапазон копируется до того, как трогать свои элементы: исключение при копировании их не портит
+        KeyContainer keys(keys_.GetAllocator());
+        ValueContainer values(values_.GetAllocator());
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            const size_t count = std::distance(first, last);
+            keys.Reserve(count);
+            values.Reserve(count);
+        }
+        for (; first != last; ++first) {
+            const auto& item = *first;
+            keys.PushBack(item.first);
+            values.PushBack(item.second);
+        }
+        MergeColumns(keys, values);
+    }
+
+    void Merge(const FlatMap& other) {
+        KeyContainer keys(other.keys_);
+        ValueContainer values(other.values_);
+        MergeColumns(keys, values);
+    }
+
+    size_t Erase(const Key& key) {
+        const size_t index = IndexOf(key);
+        if (index == GetSize()) {
+            return 0;
+        }
+        EraseAt(index);
+        return 1;
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        const size_t index = pos - cbegin();
+        EraseAt(index);
+        return {this, index};
+    }
+
+    void Reserve(size_t capacity) {
+        keys_.Reserve(capacity);
+        values_.Reserve(capacity);
+    }
+
+    void Clear() noexcept {
+        keys_.Clear();
+        values_.Clear();
+    }
+
+    void swap(FlatMap& other) noexcept {
+        keys_.swap(other.keys_);
+        values_.swap(other.values_);
+        std::swap(comp_, other.comp_);
+    }
+
+private:
+    KeyContainer keys_;
+    ValueContainer values_;
+    [[no_unique_address]] Compare comp_;
+
+    size_t LowerIndex(const Key& key) const {
+        return detail::BranchlessLowerBound(keys_.Data(), keys_.GetSize(), key, comp_);
+    }
+
+    // Индекс ключа или GetSize(), если его нет
+    size_t IndexOf(const Key& key) const {
+        const size_t index = LowerIndex(key);
+        return index != GetSize() && !comp_(key, keys_[index]) ? index : GetSize();
+    }
+
+    size_t CheckedIndexOf(const Key& key) const {
+        const size_t index = IndexOf(key);
+        if (index == GetSize()) {
+            throw std::out_of_range("Method At(key): key not found");
+        }
+        return index;
+    }
+
+    template <typename K, typename... Args>
+    std::pair<size_t, bool> TryEmplaceIndex(K&& key, Args&&... args) {
+        const size_t index = LowerIndex(key);
+        if (index != GetSize() && !comp_(key, keys_[index])) {
+            return {index, false};
+        }
+        // значение вставляется первым: если бросит ключ, значение убирается и столбцы остаются согласованы
+        values_.Emplace(values_.begin() + index, std::forward<Args>(args)...);
+        try {
+            keys_.Emplace(keys_.begin() + index, std::forward<K>(key));
+        } catch (...) {
+            values_.Erase(values_.begin() + index);
+            throw;
+        }
+        return {index, true};
+    }
+
+    void EraseAt(size_t index) {
+        keys_.Erase(keys_.begin() + index);
+        values_.Erase(values_.begin() + index);
+    }
+
+    // Сортирует столбцы по ключам перестановкой индексов, оставляя первый из равных ключей
+    void SortByKey() {
+        const size_t size = keys_.GetSize();
+        const Key* const keys = keys_.Data();
+        const bool sorted = std::adjacent_find(keys, keys + size, [this](const Key& lhs, const Key& rhs) {
+            return !comp_(lhs, rhs);
+        }) == keys + size;
+        if (sorted) {
+            return;
+        }
+        SimpleVector<size_t> order(size);
+        std::iota(order.Data(), order.Data() + size, size_t(0));
+        std::stable_sort(order.Data(), order.Data() + size, [&](size_t lhs, size_t rhs) {
+            return comp_(keys[lhs], keys[rhs]);
+        });
+        KeyContainer sorted_keys(keys_.GetAllocator());
+        ValueContainer sorted_values(values_.GetAllocator());
+        sorted_keys.Reserve(size);
+        sorted_values.Reserve(size);
+        for (const size_t index : order) {
+            if (sorted_keys.IsEmpty() || comp_(sorted_keys[sorted_keys.GetSize() - 1], keys_[index])) {
+                sorted_keys.PushBack(std::move_if_noexcept(keys_[index]));
+                sorted_values.PushBack(std::move_if_noexcept(values_[index]));
+            }
+        }
+        keys_.swap(sorted_keys);
+        values_.swap(sorted_values);
+    }
+
+    // Сливает отсортированные столбцы keys и values со своими; элементы забираются из них перемещением
+    void MergeColumns(KeyContainer& keys, ValueContainer& values) {
+        if (keys.IsEmpty()) {
+            return;
+        }
+        const size_t from = LowerIndex(keys[0]);
+        KeyContainer merged_keys(keys_.GetAllocator());
+        ValueContainer merged_values(values_.GetAllocator());
+        const size_t count = GetSize() - from + keys.GetSize();
+        merged_keys.Reserve(count);
+        merged_values.Reserve(count);
+        const auto emit = [&](Key& key, Value& value) {
+            if (merged_keys.IsEmpty() || comp_(merged_keys[merged_keys.GetSize() - 1], key)) {
+                merged_keys.PushBack(std::move_if_noexcept(key));
+                merged_values.PushBack(std::move_if_noexcept(value));
+            }
+        };
+        size_t existing = from;
+        size_t added = 0;
+        while (existing != GetSize() && added != keys.GetSize()) {
+            // при равенстве первым идёт уже имеющийся ключ, а повтор из диапазона отбрасывается
+            if (comp_(keys[added], keys_[existing])) {
+                emit(keys[added], values[added]);
+                ++added;
+            } else {
+                emit(keys_[existing], values_[existing]);
+                ++existing;
+            }
+        }
+        for (; existing != GetSize(); ++existing) {
+            emit(keys_[existing], values_[existing]);
+        }
+        for (; added != keys.GetSize(); ++added) {
+            emit(keys[added], values[added]);
+        }
+        // место в обоих столбцах резервируется до удаления хвоста: дальше перенос не выделяет память
+        // и при перемещении без исключений не может оставить столбцы разной длины.
+        // При from == GetSize() всё сводится к вставке диапазона в конец
+        keys_.Reserve(from + merged_keys.GetSize());
+        values_.Reserve(from + merged_values.GetSize());
+        keys_.Erase(keys_.begin() + from, keys_.end());
+        values_.Erase(values_.begin() + from, values_.end());
+        keys_.Append(std::make_move_iterator(merged_keys.Data()),
+                     std::make_move_iterator(merged_keys.Data() + merged_keys.GetSize()));
+        values_.Append(std::make_move_iterator(merged_values.Data()),
+                       std::make_move_iterator(merged_values.Data() + merged_values.GetSize()));
+    }
+
+    template <bool Const>
+    class BasicIterator {
+        using Owner = std::conditional_t<Const, const FlatMap, FlatMap>;
+
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ValueType;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, ConstReference, Reference>;
+        using pointer = void;
+
+        BasicIterator() noexcept = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+                : owner_(owner)
+                , index_(index)
+        {
+        }
+
+        operator BasicIterator<true>() const noexcept requires(!Const) {
+            return {owner_, index_};
+        }
+
+        reference operator*() const noexcept {
+            return {owner_->keys_[index_], owner_->values_[index_]};
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return *(*this + n);
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator old = *this;
+            --index_;
+            return old;
+        }
+
+        BasicIterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend BasicIterator operator+(difference_type n, BasicIterator it) noexcept {
+            return it += n;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend auto operator<=>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+};
+
+template <typename Key, typename Value, typename Compare, typename KeyAllocator, typename ValueAllocator>
+bool operator==(const FlatMap<Key, Value, Compare, KeyAllocator, ValueAllocator>& lhs,
+                const FlatMap<Key, Value, Compare, KeyAllocator, ValueAllocator>& rhs) {
+    return lhs.Keys() == rhs.Keys() && lhs.Values() == rhs.Values();
+}
+
+template <typename Key, typename Value, typename Compare, typename KeyAllocator, typename ValueAllocator>
+bool operator!=(const FlatMap<Key, Value, Compare, KeyAllocator, ValueAllocator>& lhs,
+                const FlatMap<Key, Value, Compare, KeyAllocator, ValueAllocator>& rhs) {
+    return !(lhs == rhs);
+}
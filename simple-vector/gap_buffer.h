@@ -0,0 +1,462 @@
+#pragma once
+
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <span>
+#include <type_traits>
+#include <utility>
+
+#include "array_ptr.h"
+#include "growth_policy.h"
+#include "memory_utils.h"
+
+// Вектор с разрывом (gap buffer): свободная часть блока лежит не в конце, а в позиции курсора.
+// Insert и Erase у курсора стоят O(1), а разрыв переезжает к новой позиции лениво, перенося
+// только элементы между старой и новой позицией. Серия вставок и удалений вокруг медленно
+// движущегося курсора (редактор, книга заявок) стоит O(1) амортизированно на операцию.
+// PushFront после MoveGap(0) или серии PushFront тоже O(1); чередование PushFront и PushBack
+// каждый раз переносит разрыв через весь вектор.
+// Элементы перед разрывом и после него доступны как два span; итераторы обходят их подряд
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DefaultGrowthPolicy>
+class GapBuffer {
+    template <bool Const>
+    class BasicIterator;
+
+public:
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    GapBuffer() noexcept(noexcept(Allocator())) = default;
+
+    explicit GapBuffer(const Allocator& alloc) noexcept
+            : items_(alloc)
+    {
+    }
+
+    GapBuffer(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+            : items_(init.size(), alloc)
+    {
+        detail::UninitializedCopy(items_.GetAllocator(), init.begin(), init.end(), items_.Get());
+        gap_begin_ = init.size();
+        gap_end_ = items_.GetSize();
+    }
+
+    GapBuffer(const GapBuffer& other)
+            : items_(other.GetSize(),
+                     std::allocator_traits<Allocator>::select_on_container_copy_construction(other.items_.GetAllocator()))
+    {
+        const std::span<const Type> before = other.BeforeGap();
+        const std::span<const Type> after = other.AfterGap();
+        detail::UninitializedCopy(items_.GetAllocator(), before.begin(), before.end(), items_.Get());
+        try {
+            detail::UninitializedCopy(items_.GetAllocator(), after.begin(), after.end(), items_.Get() + before.size());
+        } catch (...) {
+            detail::DestroyN(items_.GetAllocator(), items_.Get(), before.size());
+            throw;
+        }
+        gap_begin_ = other.GetSize();
+        gap_end_ = items_.GetSize();
+    }
+
+    GapBuffer& operator=(const GapBuffer& rhs) {
+        if (this != &rhs) {
+            GapBuffer tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    GapBuffer(GapBuffer&& other) noexcept
+            : items_(std::move(other.items_))
+            , gap_begin_(std::exchange(other.gap_begin_, 0))
+            , gap_end_(std::exchange(other.gap_end_, 0))
+    {
+    }
+
+    GapBuffer& operator=(GapBuffer&& rhs) noexcept {
+        if (this != &rhs) {
+            GapBuffer tmp(std::move(rhs));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~GapBuffer() {
+        Clear();
+    }
+
+    size_t GetSize() const noexcept {
+        return items_.GetSize() - GapSize();
+    }
+
+    size_t GetCapacity() const noexcept {
+        return items_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    // Позиция курсора: индекс элемента, который будет сразу после разрыва
+    size_t GetGapPosition() const noexcept {
+        return gap_begin_;
+    }
+
+    std::span<Type> BeforeGap() noexcept {
+        return {items_.Get(), gap_begin_};
+    }
+
+    std::span<const Type> BeforeGap() const noexcept {
+        return {items_.Get(), gap_begin_};
+    }
+
+    std::span<Type> AfterGap() noexcept {
+        return {items_.Get() + gap_end_, items_.GetSize() - gap_end_};
+    }
+
+    std::span<const Type> AfterGap() const noexcept {
+        return {items_.Get() + gap_end_, items_.GetSize() - gap_end_};
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < GetSize());
+        return *Slot(index);
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return *Slot(index);
+    }
+
+    Type& At(size_t index) {
+        if (index >= GetSize()) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return *Slot(index);
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return *Slot(index);
+    }
+
+    Iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    Iterator end() noexcept {
+        return {this, GetSize()};
+    }
+
+    ConstIterator begin() const noexcept {
+        return {this, 0};
+    }
+
+    ConstIterator end() const noexcept {
+        return {this, GetSize()};
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    // Переносит разрыв так, чтобы перед ним оказались первые position элементов
+    void MoveGap(size_t position) {
+        assert(position <= GetSize());
+        Type* const data = items_.Get();
+        if (GapSize() == 0) {
+            // пустой разрыв переезжает без переноса элементов
+            gap_begin_ = gap_end_ = position;
+        } else if (position < gap_begin_) {
+            const size_t count = gap_begin_ - position;
+            if constexpr (detail::kRelocateBitwise<Allocator, Type>) {
+                detail::RelocateBitwise(data + position, count, data + gap_end_ - count);
+                gap_begin_ -= count;
+                gap_end_ -= count;
+            } else {
+                // по одному элементу, чтобы исключение оставляло буфер целым
+                while (gap_begin_ > position) {
+                    detail::Construct(items_.GetAllocator(), data + gap_end_ - 1, std::move(data[gap_begin_ - 1]));
+                    --gap_end_;
+                    detail::Destroy(items_.GetAllocator(), data + --gap_begin_);
+                }
+            }
+        } else if (position > gap_begin_) {
+            const size_t count = position - gap_begin_;
+            if constexpr (detail::kRelocateBitwise<Allocator, Type>) {
+                detail::RelocateBitwise(data + gap_end_, count, data + gap_begin_);
+                gap_begin_ += count;
+                gap_end_ += count;
+            } else {
+                while (gap_begin_ < position) {
+                    detail::Construct(items_.GetAllocator(), data + gap_begin_, std::move(data[gap_end_]));
+                    ++gap_begin_;
+                    detail::Destroy(items_.GetAllocator(), data + gap_end_++);
+                }
+            }
+        }
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceAt(GetSize(), item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceAt(GetSize(), std::move(item));
+    }
+
+    // Новый элемент встаёт сразу после разрыва, и курсор остаётся в начале: следующий PushFront
+    // ничего не переносит
+    template <typename... Args>
+    Type& EmplaceFront(Args&&... args) {
+        if (gap_begin_ == 0 && GapSize() != 0) {
+            detail::Construct(items_.GetAllocator(), items_.Get() + gap_end_ - 1, std::forward<Args>(args)...);
+        } else {
+            Type value(std::forward<Args>(args)...);
+            ReserveGap();
+            MoveGap(0);
+            detail::Construct(items_.GetAllocator(), items_.Get() + gap_end_ - 1, std::move(value));
+        }
+        return items_[--gap_end_];
+    }
+
+    void PushFront(const Type& item) {
+        EmplaceFront(item);
+    }
+
+    void PushFront(Type&& item) {
+        EmplaceFront(std::move(item));
+    }
+
+    void PopBack() {
+        Erase(cend() - 1);
+    }
+
+    void PopFront() {
+        Erase(cbegin());
+    }
+
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    // Конструирует элемент перед pos; курсор встаёт сразу за ним
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
+        const size_t position = pos - cbegin();
+        EmplaceAt(position, std::forward<Args>(args)...);
+        return begin() + position;
+    }
+
+    // Удаляет элемент pos; разрыв встаёт на его место
+    Iterator Erase(ConstIterator pos) {
+        const size_t position = pos - cbegin();
+        assert(position < GetSize());
+        if (position + 1 == gap_begin_) {
+            detail::Destroy(items_.GetAllocator(), items_.Get() + --gap_begin_);
+        } else {
+            MoveGap(position);
+            detail::Destroy(items_.GetAllocator(), items_.Get() + gap_end_++);
+        }
+        return begin() + position;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > GetCapacity()) {
+            Reallocate(new_capacity);
+        }
+    }
+
+    void Clear() noexcept {
+        detail::DestroyN(items_.GetAllocator(), items_.Get(), gap_begin_);
+        detail::DestroyN(items_.GetAllocator(), items_.Get() + gap_end_, items_.GetSize() - gap_end_);
+        gap_begin_ = 0;
+        gap_end_ = items_.GetSize();
+    }
+
+    void swap(GapBuffer& other) noexcept {
+        items_.swap(other.items_);
+        std::swap(gap_begin_, other.gap_begin_);
+        std::swap(gap_end_, other.gap_end_);
+    }
+
+private:
+    ArrayPtr<Type, Allocator> items_;
+    // свободная часть блока: [gap_begin_, gap_end_)
+    size_t gap_begin_ = 0;
+    size_t gap_end_ = 0;
+
+    size_t GapSize() const noexcept {
+        return gap_end_ - gap_begin_;
+    }
+
+    Type* Slot(size_t index) const noexcept {
+        return items_.Get() + (index < gap_begin_ ? index : index + GapSize());
+    }
+
+    template <typename... Args>
+    void EmplaceAt(size_t position, Args&&... args) {
+        assert(position <= GetSize());
+        if (position == gap_begin_ && GapSize() != 0) {
+            detail::Construct(items_.GetAllocator(), items_.Get() + gap_begin_, std::forward<Args>(args)...);
+        } else {
+            // аргументы могут ссылаться на элементы, которые переедут вместе с разрывом
+            Type value(std::forward<Args>(args)...);
+            ReserveGap();
+            MoveGap(position);
+            detail::Construct(items_.GetAllocator(), items_.Get() + gap_begin_, std::move(value));
+        }
+        ++gap_begin_;
+    }
+
+    void ReserveGap() {
+        if (GapSize() == 0) {
+            Reallocate(GrowthPolicy::NextCapacity(GetCapacity(), GetSize() + 1, sizeof(Type)));
+        }
+    }
+
+    // Переносит элементы в новый блок, сохраняя позицию разрыва; при исключении буфер не меняется
+    void Reallocate(size_t new_capacity) {
+        ArrayPtr<Type, Allocator> tmp(new_capacity, items_.GetAllocator());
+        const size_t tail = items_.GetSize() - gap_end_;
+        Type* const tail_dest = tmp.Get() + tmp.GetSize() - tail;
+        if constexpr (detail::kRelocateBitwise<Allocator, Type>) {
+            detail::RelocateBitwise(items_.Get(), gap_begin_, tmp.Get());
+            detail::RelocateBitwise(items_.Get() + gap_end_, tail, tail_dest);
+        } else {
+            detail::UninitializedRelocateN(tmp.GetAllocator(), items_.Get(), gap_begin_, tmp.Get());
+            try {
+                detail::UninitializedRelocateN(tmp.GetAllocator(), items_.Get() + gap_end_, tail, tail_dest);
+            } catch (...) {
+                detail::DestroyN(tmp.GetAllocator(), tmp.Get(), gap_begin_);
+                throw;
+            }
+            detail::DestroyN(items_.GetAllocator(), items_.Get(), gap_begin_);
+            detail::DestroyN(items_.GetAllocator(), items_.Get() + gap_end_, tail);
+        }
+        items_.swap(tmp);
+        gap_end_ = items_.GetSize() - tail;
+    }
+
+    template <bool Const>
+    class BasicIterator {
+        using Owner = std::conditional_t<Const, const GapBuffer, GapBuffer>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const Type&, Type&>;
+        using pointer = std::conditional_t<Const, const Type*, Type*>;
+
+        BasicIterator() noexcept = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+                : owner_(owner)
+                , index_(index)
+        {
+        }
+
+        operator BasicIterator<true>() const noexcept requires(!Const) {
+            return {owner_, index_};
+        }
+
+        reference operator*() const noexcept {
+            return *owner_->Slot(index_);
+        }
+
+        pointer operator->() const noexcept {
+            return owner_->Slot(index_);
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return *owner_->Slot(index_ + n);
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator old = *this;
+            --index_;
+            return old;
+        }
+
+        BasicIterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend BasicIterator operator+(difference_type n, BasicIterator it) noexcept {
+            return it += n;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend auto operator<=>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+};
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+bool operator==(const GapBuffer<Type, Allocator, GrowthPolicy>& lhs, const GapBuffer<Type, Allocator, GrowthPolicy>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+bool operator!=(const GapBuffer<Type, Allocator, GrowthPolicy>& lhs, const GapBuffer<Type, Allocator, GrowthPolicy>& rhs) {
+    return !(lhs == rhs);
+}
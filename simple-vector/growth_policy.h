@@ -0,0 +1,55 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
+
+// Политики роста вместимости SimpleVector. Политика - тип со статическим методом
+//     static size_t NextCapacity(size_t capacity, size_t required, size_t element_size);
+// возвращающим новую вместимость не меньше required для вектора с текущей вместимостью capacity
+
+// Удваивает вместимость
+struct GrowthFactor2 {
+    static size_t NextCapacity(size_t capacity, size_t required, size_t) noexcept {
+        return std::max({required, 2 * capacity, size_t(1)});
+    }
+};
+
+// Увеличивает вместимость в полтора раза: больше перевыделений, меньше неиспользуемой памяти
+struct GrowthFactor1_5 {
+    static size_t NextCapacity(size_t capacity, size_t required, size_t) noexcept {
+        return std::max({required, capacity + capacity / 2, size_t(1)});
+    }
+};
+
+// Растёт по политике Base, затем округляет размер блока в байтах вверх до класса размера
+// типичного malloc: шаг 16 байт до 128 байт, четыре класса на каждое удвоение до PageSize,
+// дальше - целое число страниц. Хвост, который аллокатор всё равно выделил бы, становится вместимостью
+template <typename Base = GrowthFactor2, size_t PageSize = 4096>
+struct SizeClassGrowth {
+    static_assert(std::has_single_bit(PageSize), "PageSize must be a power of two");
+
+    static size_t NextCapacity(size_t capacity, size_t required, size_t element_size) noexcept {
+        const size_t grown = Base::NextCapacity(capacity, required, element_size);
+        return std::max(grown, RoundUpBytes(grown * element_size) / element_size);
+    }
+
+    static size_t RoundUpBytes(size_t bytes) noexcept {
+        if (bytes <= 128) {
+            return RoundUp(bytes, 16);
+        }
+        if (bytes < PageSize) {
+            // bytes лежит в (2^k, 2^(k+1)], классы идут с шагом 2^k / 4
+            const size_t lower = std::bit_floor(bytes - 1);
+            return RoundUp(bytes, lower / 4);
+        }
+        return RoundUp(bytes, PageSize);
+    }
+
+private:
+    static size_t RoundUp(size_t value, size_t step) noexcept {
+        return (value + step - 1) / step * step;
+    }
+};
+
+using DefaultGrowthPolicy = SizeClassGrowth<>;
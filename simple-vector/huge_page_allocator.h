@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+
+#include <sys/mman.h>
+
+#include "simple_vector.h"
+
+// Какие большие страницы просить у ядра для крупных блоков
+enum class HugePageMode {
+    // обычное анонимное отображение, выровненное на 2 МиБ, с madvise(MADV_HUGEPAGE)
+    kTransparent,
+    // явные страницы hugetlbfs по 2 МиБ; если они не зарезервированы, как kTransparent
+    kExplicit2MB,
+    // явные страницы по 1 ГиБ для блоков от 1 ГиБ, меньшие блоки как kExplicit2MB
+    kExplicit1GB,
+};
+
+namespace detail {
+
+inline constexpr size_t kHugePageSize = size_t(1) << 21;
+inline constexpr size_t kGiganticPageSize = size_t(1) << 30;
+
+inline size_t RoundUpTo(size_t bytes, size_t page) noexcept {
+    return (bytes + page - 1) & ~(page - 1);
+}
+
+// Анонимное отображение bytes байт (кратно 2 МиБ), выровненное на 2 МиБ, чтобы ядро могло
+// отдать его прозрачными большими страницами
+inline void* MapTransparentHugePages(size_t bytes) {
+    const size_t mapped = bytes + kHugePageSize;
+    void* raw = ::mmap(nullptr, mapped, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+        throw std::bad_alloc();
+    }
+    // лишнее до выровненного начала и после конца возвращается сразу
+    const auto begin = reinterpret_cast<uintptr_t>(raw);
+    const uintptr_t aligned = RoundUpTo(begin, kHugePageSize);
+    if (aligned != begin) {
+        ::munmap(raw, aligned - begin);
+    }
+    const size_t tail = begin + mapped - (aligned + bytes);
+    if (tail != 0) {
+        ::munmap(reinterpret_cast<void*>(aligned + bytes), tail);
+    }
+    void* p = reinterpret_cast<void*>(aligned);
+#ifdef MADV_HUGEPAGE
+    ::madvise(p, bytes, MADV_HUGEPAGE);
+#endif
+    return p;
+}
+
+inline void* MapHugePages(size_t bytes, size_t page, bool explicit_pages) {
+#if defined(MAP_HUGETLB) && defined(MAP_HUGE_SHIFT)
+    if (explicit_pages) {
+        const int size_flag = (page == kGiganticPageSize ? 30 : 21) << MAP_HUGE_SHIFT;
+        void* p = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB | size_flag,
+                         -1, 0);
+        if (p != MAP_FAILED) {
+            return p;
+        }
+    }
+#else
+    (void)page;
+    (void)explicit_pages;
+#endif
+    return MapTransparentHugePages(bytes);
+}
+
+}  // namespace detail
+
+// Аллокатор для очень больших векторов: блоки от 2 МиБ берутся прямо у ядра через mmap
+// на больших страницах, что снимает нагрузку с TLB при случайном доступе. Размер блока
+// округляется вверх до целой большой страницы, и через allocate_at_least весь округлённый
+// блок становится вместимостью SimpleVector. Меньшие блоки выделяются как у std::allocator
+template <typename Type, HugePageMode Mode = HugePageMode::kTransparent>
+class HugePageAllocator {
+public:
+    using value_type = Type;
+
+    static_assert(alignof(Type) <= detail::kHugePageSize, "huge pages cannot satisfy this alignment");
+
+    template <typename Other>
+    struct rebind {
+        using other = HugePageAllocator<Other, Mode>;
+    };
+
+    struct Result {
+        Type* ptr;
+        size_t count;
+    };
+
+    // Блоки от этого размера в байтах отображаются на большие страницы
+    static constexpr size_t kThreshold = detail::kHugePageSize;
+
+    HugePageAllocator() noexcept = default;
+
+    template <typename Other>
+    HugePageAllocator(const HugePageAllocator<Other, Mode>&) noexcept {
+    }
+
+    Type* allocate(size_t n) {
+        return allocate_at_least(n).ptr;
+    }
+
+    Result allocate_at_least(size_t n) {
+        if (n > (std::numeric_limits<size_t>::max() - detail::kGiganticPageSize) / sizeof(Type)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = n * sizeof(Type);
+        if (bytes < kThreshold) {
+            return {std::allocator<Type>().allocate(n), n};
+        }
+        const size_t page = PageFor(bytes);
+        const size_t rounded = detail::RoundUpTo(bytes, page);
+        void* p = detail::MapHugePages(rounded, page, Mode != HugePageMode::kTransparent);
+        return {static_cast<Type*>(p), rounded / sizeof(Type)};
+    }
+
+    // n - число, отданное allocate_at_least, или запрошенное у allocate: оба дают тот же размер отображения
+    void deallocate(Type* p, size_t n) noexcept {
+        const size_t bytes = n * sizeof(Type);
+        if (bytes < kThreshold) {
+            std::allocator<Type>().deallocate(p, n);
+        } else {
+            ::munmap(p, detail::RoundUpTo(bytes, PageFor(bytes)));
+        }
+    }
+
+    template <typename Other>
+    bool operator==(const HugePageAllocator<Other, Mode>&) const noexcept {
+        return true;
+    }
+
+private:
+    static constexpr size_t PageFor(size_t bytes) noexcept {
+        return Mode == HugePageMode::kExplicit1GB && bytes >= detail::kGiganticPageSize ? detail::kGiganticPageSize
+                                                                                        : detail::kHugePageSize;
+    }
+};
+
+template <typename Type, HugePageMode Mode = HugePageMode::kTransparent>
+using HugePageSimpleVector = SimpleVector<Type, HugePageAllocator<Type, Mode>>;
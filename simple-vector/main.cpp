@@ -1,8 +1,49 @@
+#include "aligned_allocator.h"
+#include "concurrent_vector.h"
+#include "cow_vector.h"
+#include "flat_map.h"
+#include "flat_set.h"
+#include "gap_buffer.h"
+#include "huge_page_allocator.h"
+#include "malloc_allocator.h"
+#include "mmap_vector.h"
+#include "parallel_algorithms.h"
+#include "persistent_vector.h"
+#include "segmented_vector.h"
+#include "sharded_appender.h"
+#include "simple_span.h"
 #include "simple_vector.h"
+#include "small_simple_vector.h"
+#include "soa_vector.h"
+#include "static_vector.h"
+#include "vector_serialization.h"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
 #include <iostream>
+#include <iterator>
+#include <limits>
+#include <list>
+#include <map>
+#include <memory>
+#include <memory_resource>
 #include <numeric>
+#include <set>
+#include <span>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
 
 using namespace std;
 
@@ -31,6 +72,31 @@ private:
     size_t x_;
 };
 
+// Считает живые экземпляры, чтобы проверять конструирование и разрушение элементов
+class Counted {
+public:
+    static inline int alive = 0;
+
+    explicit Counted(int value)
+        : value_(value) {
+        ++alive;
+    }
+    Counted(const Counted& other)
+        : value_(other.value_) {
+        ++alive;
+    }
+    Counted& operator=(const Counted& other) = default;
+    ~Counted() {
+        --alive;
+    }
+    int GetValue() const {
+        return value_;
+    }
+
+private:
+    int value_;
+};
+
 SimpleVector<int> GenerateVector(size_t size) {
     SimpleVector<int> v(size);
     iota(v.begin(), v.end(), 1);
@@ -149,6 +215,1668 @@ void TestNoncopiableErase() {
     cout << "Done!" << endl << endl;
 }
 
+void TestUninitializedStorage() {
+    cout << "Test uninitialized storage" << endl;
+    {
+        SimpleVector<Counted> v;
+        v.Reserve(100);
+        assert(v.GetCapacity() == 100);
+        assert(Counted::alive == 0);
+
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(Counted(i));
+        }
+        assert(Counted::alive == 10);
+
+        v.Insert(v.begin() + 5, Counted(42));
+        assert(Counted::alive == 11);
+        assert(v[5].GetValue() == 42 && v[6].GetValue() == 5);
+
+        v.Erase(v.begin());
+        v.PopBack();
+        assert(Counted::alive == 9);
+
+        while (v.GetSize() > 3) {
+            v.PopBack();
+        }
+        assert(Counted::alive == 3);
+
+        SimpleVector<Counted> copy(v);
+        assert(Counted::alive == 6);
+        copy = SimpleVector<Counted>(20, Counted(7));
+        assert(copy.GetSize() == 20 && Counted::alive == 23);
+        copy.Clear();
+        assert(Counted::alive == 3);
+    }
+    assert(Counted::alive == 0);
+    cout << "Done!" << endl << endl;
+}
+
+// Аллокатор-обёртка над std::allocator, считающий число выделений
+template <typename Type>
+struct CountingAllocator {
+    using value_type = Type;
+
+    static inline size_t allocations = 0;
+
+    CountingAllocator() = default;
+    template <typename Other>
+    CountingAllocator(const CountingAllocator<Other>&) noexcept {
+    }
+
+    Type* allocate(size_t n) {
+        ++allocations;
+        return std::allocator<Type>().allocate(n);
+    }
+    void deallocate(Type* p, size_t n) noexcept {
+        std::allocator<Type>().deallocate(p, n);
+    }
+
+    bool operator==(const CountingAllocator&) const noexcept {
+        return true;
+    }
+};
+
+void TestAllocator() {
+    cout << "Test allocator" << endl;
+    {
+        SimpleVector<int, CountingAllocator<int>> v;
+        v.Reserve(10);
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(i);
+        }
+        assert(CountingAllocator<int>::allocations == 1);
+        auto copy = v;
+        assert(CountingAllocator<int>::allocations == 2);
+        assert(copy == v);
+    }
+    {
+        array<byte, 1024> buffer;
+        pmr::monotonic_buffer_resource arena(buffer.data(), buffer.size(), pmr::null_memory_resource());
+        PmrSimpleVector<pmr::string> v(&arena);
+        v.PushBack("a string long enough to skip the small string optimization");
+        v.Insert(v.begin(), "b");
+        assert(v.GetAllocator().resource() == &arena);
+        // строки получают аллокатор вектора
+        assert(v[1].get_allocator().resource() == &arena);
+
+        PmrSimpleVector<pmr::string> other(move(v), pmr::new_delete_resource());
+        assert(other.GetSize() == 2 && v.GetSize() == 0);
+        assert(other[0] == "b");
+    }
+    cout << "Done!" << endl << endl;
+}
+
+// Считает перемещения, чтобы проверять отсутствие лишних временных объектов
+struct MoveCounter {
+    static inline int moves = 0;
+
+    MoveCounter(int a, string b)
+        : a(a)
+        , b(move(b)) {
+    }
+    MoveCounter(MoveCounter&& other) noexcept
+        : a(other.a)
+        , b(move(other.b)) {
+        ++moves;
+    }
+    MoveCounter& operator=(MoveCounter&& other) noexcept {
+        a = other.a;
+        b = move(other.b);
+        ++moves;
+        return *this;
+    }
+
+    int a;
+    string b;
+};
+
+void TestEmplace() {
+    cout << "Test emplace" << endl;
+    SimpleVector<MoveCounter> v;
+    v.Reserve(4);
+    MoveCounter& ref = v.EmplaceBack(1, "one");
+    assert(&ref == &v[0] && ref.a == 1 && ref.b == "one");
+    auto it = v.Emplace(v.end(), 3, "three");
+    assert(it == v.begin() + 1);
+    assert(MoveCounter::moves == 0);
+
+    it = v.Emplace(v.begin() + 1, 2, "two");
+    assert(it->a == 2 && v[2].b == "three");
+
+    MoveCounter::moves = 0;
+    v.EmplaceBack(4, "four");
+    // переезд в новое хранилище: элемент создаётся на месте, старые перемещаются
+    v.EmplaceBack(5, "five");
+    assert(MoveCounter::moves == 4);
+    assert(v.GetSize() == 5 && v[4].b == "five");
+
+    SimpleVector<string> strings;
+    strings.PushBack("abc");
+    // аргумент ссылается на элемент самого вектора, который переезжает
+    strings.EmplaceBack(strings[0]);
+    strings.Emplace(strings.begin(), strings[1]);
+    assert(strings.GetSize() == 3 && strings[0] == "abc" && strings[2] == "abc");
+    cout << "Done!" << endl << endl;
+}
+
+void TestTriviallyRelocatable() {
+    cout << "Test trivially relocatable" << endl;
+    static_assert(IsTriviallyRelocatable<int>::value);
+    static_assert(IsTriviallyRelocatable<unique_ptr<string>>::value);
+    static_assert(!IsTriviallyRelocatable<string>::value);
+
+    SimpleVector<unique_ptr<int>> v;
+    for (int i = 0; i < 10; ++i) {
+        v.Insert(v.begin(), make_unique<int>(i));
+    }
+    v.Erase(v.begin() + 3);
+    v.Emplace(v.begin() + 1, make_unique<int>(100));
+    assert(v.GetSize() == 10);
+    assert(*v[0] == 9 && *v[1] == 100 && *v[2] == 8 && *v[4] == 5);
+
+    struct Point {
+        int x, y, z, w;
+    };
+    SimpleVector<Point, MallocAllocator<Point>> points;
+    for (int i = 0; i < 1000; ++i) {
+        points.PushBack({i, i, i, i});
+    }
+    points.Resize(2000);
+    points.Reserve(5000);
+    assert(points.GetCapacity() == 5000 && points.GetSize() == 2000);
+    assert(points[999].w == 999 && points[1999].x == 0);
+    points.EmplaceBack(points[5]);
+    assert(points[2000].y == 5);
+    cout << "Done!" << endl << endl;
+}
+
+// Аллокатор, выдающий блоки кратно 8 элементам и сообщающий об этом через allocate_at_least
+template <typename Type>
+struct BucketAllocator : std::allocator<Type> {
+    template <typename Other>
+    struct rebind {
+        using other = BucketAllocator<Other>;
+    };
+
+    struct Result {
+        Type* ptr;
+        size_t count;
+    };
+
+    Result allocate_at_least(size_t n) {
+        const size_t count = (n + 7) / 8 * 8;
+        return {this->allocate(count), count};
+    }
+};
+
+void TestGrowthPolicy() {
+    cout << "Test growth policy" << endl;
+    {
+        SimpleVector<int, allocator<int>, GrowthFactor1_5> v;
+        SimpleVector<size_t> capacities;
+        for (int i = 0; i < 20; ++i) {
+            v.PushBack(i);
+            if (capacities.IsEmpty() || capacities[capacities.GetSize() - 1] != v.GetCapacity()) {
+                capacities.PushBack(v.GetCapacity());
+            }
+        }
+        assert((capacities == SimpleVector<size_t>{1, 2, 3, 4, 6, 9, 13, 19, 28}));
+    }
+    {
+        SimpleVector<int, allocator<int>, GrowthFactor2> v;
+        v.Resize(5);
+        v.PushBack(0);
+        assert(v.GetCapacity() == 10);
+    }
+    {
+        using Policy = SizeClassGrowth<GrowthFactor2, 4096>;
+        assert(Policy::RoundUpBytes(1) == 16);
+        assert(Policy::RoundUpBytes(129) == 160);
+        assert(Policy::RoundUpBytes(1000) == 1024);
+        assert(Policy::RoundUpBytes(5000) == 8192);
+
+        // удвоение даёт 6 элементов по 4 байта, 24 байта округляются до 32, то есть до 8 элементов
+        SimpleVector<int32_t> v(3);
+        v.PushBack(0);
+        assert(v.GetCapacity() == 8);
+    }
+    {
+        SimpleVector<int, BucketAllocator<int>> v;
+        v.Reserve(3);
+        assert(v.GetCapacity() == 8);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestShrinkToFit() {
+    cout << "Test shrink to fit" << endl;
+    {
+        SimpleVector<Counted> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(Counted(i));
+        }
+        while (v.GetSize() > 10) {
+            v.PopBack();
+        }
+        assert(v.GetCapacity() >= 100);
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 10 && v.GetSize() == 10);
+        assert(v[9].GetValue() == 9 && Counted::alive == 10);
+
+        v.Clear(true);
+        assert(v.GetCapacity() == 0 && v.IsEmpty() && Counted::alive == 0);
+        v.PushBack(Counted(1));
+        assert(v.GetSize() == 1);
+    }
+    {
+        SimpleVector<int, MallocAllocator<int>> v(1000, 5);
+        v.Resize(3);
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 3 && v[2] == 5);
+        v.Clear(false);
+        assert(v.GetCapacity() == 3);
+        v.ShrinkToFit();
+        assert(v.GetCapacity() == 0);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestRangeInsert() {
+    cout << "Test range insert" << endl;
+    const vector<string> source = {"a", "b", "c", "d"};
+    {
+        SimpleVector<string> v = {"x", "y", "z"};
+        v.Reserve(20);
+        // хвост длиннее вставки
+        auto it = v.InsertRange(v.begin(), source.begin(), source.begin() + 2);
+        assert(it == v.begin());
+        assert((v == SimpleVector<string>{"a", "b", "x", "y", "z"}));
+        // вставка длиннее хвоста
+        v.InsertRange(v.end() - 1, source.begin(), source.end());
+        assert((v == SimpleVector<string>{"a", "b", "x", "y", "a", "b", "c", "d", "z"}));
+        assert(v.GetCapacity() == 20);
+    }
+    {
+        SimpleVector<int> v = {1, 2, 3};
+        const list<int> values = {7, 8, 9, 10};
+        // с перевыделением и без
+        v.InsertRange(v.begin() + 1, values.begin(), values.end());
+        v.Reserve(100);
+        v.InsertRange(v.begin() + 2, values.begin(), values.end());
+        assert((v == SimpleVector<int>{1, 7, 7, 8, 9, 10, 8, 9, 10, 2, 3}));
+
+        v.Append(values.begin(), values.end());
+        assert(v.GetSize() == 15 && v[14] == 10);
+
+        istringstream input("4 5 6");
+        v.InsertRange(v.begin(), istream_iterator<int>(input), istream_iterator<int>());
+        assert(v[0] == 4 && v[2] == 6 && v[3] == 1 && v.GetSize() == 18);
+    }
+    {
+        SimpleVector<string> v = {"1", "2", "3"};
+        v.Assign(source.begin(), source.begin() + 1);
+        assert((v == SimpleVector<string>{"a"}));
+        v.Assign(source.begin(), source.begin() + 3);
+        assert((v == SimpleVector<string>{"a", "b", "c"}));
+        v.Assign(source.begin(), source.end());
+        assert((v == SimpleVector<string>{"a", "b", "c", "d"}));
+
+        istringstream input("q w");
+        v.Assign(istream_iterator<string>(input), istream_iterator<string>());
+        assert((v == SimpleVector<string>{"q", "w"}));
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestRangeErase() {
+    cout << "Test range erase" << endl;
+    {
+        SimpleVector<Counted> v;
+        for (int i = 0; i < 10; ++i) {
+            v.PushBack(Counted(i));
+        }
+        auto it = v.Erase(v.begin() + 2, v.begin() + 5);
+        assert(it->GetValue() == 5 && v.GetSize() == 7 && Counted::alive == 7);
+        it = v.Erase(v.begin() + 4, v.end());
+        assert(it == v.end() && v.GetSize() == 4 && Counted::alive == 4);
+        it = v.Erase(v.begin(), v.begin());
+        assert(it == v.begin() && v.GetSize() == 4);
+
+        const size_t removed = EraseIf(v, [](const Counted& c) {
+            return c.GetValue() % 2 == 1;
+        });
+        assert(removed == 2 && v.GetSize() == 2 && Counted::alive == 2);
+        assert(v[0].GetValue() == 0 && v[1].GetValue() == 6);
+    }
+    assert(Counted::alive == 0);
+    {
+        SimpleVector<int> v(100);
+        iota(v.begin(), v.end(), 0);
+        v.Erase(v.begin() + 10, v.begin() + 90);
+        assert(v.GetSize() == 20 && v[9] == 9 && v[10] == 90);
+        assert(EraseIf(v, [](int x) { return x >= 5; }) == 15);
+        assert((v == SimpleVector<int>{0, 1, 2, 3, 4}));
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestSmallSimpleVector() {
+    cout << "Test small simple vector" << endl;
+    CountingAllocator<string>::allocations = 0;
+    using Small = SmallSimpleVector<string, 4, CountingAllocator<string>>;
+    {
+        Small v = {"a", "b", "c"};
+        v.Insert(v.begin(), "z");
+        assert(v.IsInline() && v.GetCapacity() == 4);
+        assert(CountingAllocator<string>::allocations == 0);
+
+        Small moved(move(v));
+        assert(moved.IsInline() && moved.GetSize() == 4 && v.IsEmpty());
+        assert((moved == Small{"z", "a", "b", "c"}));
+
+        moved.PushBack("d");
+        assert(!moved.IsInline() && CountingAllocator<string>::allocations == 1);
+        const string* data = &moved[0];
+        Small stolen(move(moved));
+        assert(&stolen[0] == data && moved.IsInline() && moved.IsEmpty());
+
+        stolen.Erase(stolen.begin(), stolen.begin() + 2);
+        stolen.ShrinkToFit();
+        assert(stolen.IsInline() && (stolen == Small{"b", "c", "d"}));
+
+        Small other(10, "x");
+        other.swap(stolen);
+        assert(other.GetSize() == 3 && stolen.GetSize() == 10 && stolen[9] == "x");
+
+        Small copy = stolen;
+        copy = other;
+        assert(copy == other && copy.IsInline() == false);
+        assert(EraseIf(stolen, [](const string& s) { return s == "x"; }) == 10);
+        stolen.Clear(true);
+        assert(stolen.IsInline());
+    }
+    {
+        SmallSimpleVector<Counted, 2> v;
+        for (int i = 0; i < 5; ++i) {
+            v.Emplace(v.begin(), i);
+        }
+        assert(Counted::alive == 5 && v[0].GetValue() == 4);
+        SmallSimpleVector<Counted, 2> copy;
+        copy = v;
+        v = move(copy);
+        assert(Counted::alive == 5);
+    }
+    assert(Counted::alive == 0);
+    cout << "Done!" << endl << endl;
+}
+
+constexpr int StaticVectorSum() {
+    StaticVector<int, 8> v = {3, 1, 2};
+    v.Insert(v.begin(), 10);
+    v.Erase(v.begin() + 1);
+    v.PushBack(5);
+    int sum = 0;
+    for (int x : v) {
+        sum += x;
+    }
+    return sum;
+}
+
+void TestStaticVector() {
+    cout << "Test static vector" << endl;
+    static_assert(StaticVectorSum() == 18);
+    static_assert(StaticVector<int, 3>{1, 2} < StaticVector<int, 3>{1, 3});
+    {
+        StaticVector<Counted, 3> v;
+        assert(v.TryPushBack(Counted(1)));
+        assert(v.TryEmplaceBack(2) != nullptr);
+        v.Emplace(v.begin(), 0);
+        assert(v.IsFull() && !v.TryPushBack(Counted(3)));
+        assert(v.TryEmplace(v.begin(), 5) == v.end());
+        assert(Counted::alive == 3);
+
+        bool thrown = false;
+        try {
+            v.PushBack(Counted(4));
+        } catch (const length_error&) {
+            thrown = true;
+        }
+        assert(thrown && v.GetSize() == 3);
+
+        StaticVector<Counted, 3> other(1, Counted(9));
+        other.swap(v);
+        assert(other.GetSize() == 3 && v.GetSize() == 1 && v[0].GetValue() == 9);
+        assert(other[0].GetValue() == 0 && other[2].GetValue() == 2);
+        v = other;
+        assert(EraseIf(v, [](const Counted& c) { return c.GetValue() > 0; }) == 2);
+        assert(Counted::alive == 4);
+    }
+    assert(Counted::alive == 0);
+    {
+        StaticVector<string, 4> v = {"b", "c"};
+        const string a[] = {"a", "x"};
+        v.InsertRange(v.begin(), a, a + 1);
+        assert((v == StaticVector<string, 4>{"a", "b", "c"}));
+        StaticVector<string, 4> moved(move(v));
+        assert(v.IsEmpty() && moved.At(2) == "c");
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestStats() {
+    cout << "Test stats" << endl;
+#ifdef SIMPLE_VECTOR_STATS
+    ResetGlobalVectorStats();
+    {
+        SimpleVector<int> v;
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(i);
+        }
+        const VectorStats grown = v.GetStats();
+        assert(grown.allocations >= 2 && grown.reallocations == grown.allocations - 1);
+        assert(grown.elements_moved > 0 && grown.elements_copied == 0);
+        assert(grown.bytes_allocated >= 100 * sizeof(int));
+        assert(grown.peak_capacity == v.GetCapacity());
+
+        v.Insert(v.begin(), -1);
+        v.Erase(v.begin() + 50);
+        const VectorStats shifted = v.GetStats();
+        assert(shifted.elements_moved >= grown.elements_moved + 100 + 50);
+
+        SimpleVector<int> copy(v);
+        assert(copy.GetStats().allocations == 1 && copy.GetStats().elements_copied == 100);
+        SimpleVector<int> moved(move(copy));
+        assert(moved.GetStats().allocations == 0 && moved.GetStats().elements_moved == 0);
+
+        const VectorStats global = GetGlobalVectorStats();
+        assert(global.allocations == shifted.allocations + 1);
+        assert(global.elements_copied == 100);
+        assert(global.peak_capacity >= v.GetCapacity());
+    }
+    {
+        SimpleVector<Counted> v(Reserve(2));
+        v.EmplaceBack(1);
+        v.EmplaceBack(2);
+        v.EmplaceBack(3);
+        assert(v.GetStats().allocations == 2 && v.GetStats().reallocations == 1);
+        assert(v.GetStats().elements_moved == 2);
+    }
+    ResetGlobalVectorStats();
+    assert(GetGlobalVectorStats().allocations == 0);
+#else
+    // без SIMPLE_VECTOR_STATS счётчик не занимает места
+    static_assert(sizeof(SimpleVector<int>) == 2 * sizeof(void*) + sizeof(size_t) * (detail::kVectorChecksEnabled ? 2 : 1));
+    SimpleVector<int> v(10);
+    assert(v.GetStats().allocations == 0 && GetGlobalVectorStats().allocations == 0);
+#endif
+    cout << "Done!" << endl << endl;
+}
+
+void TestParallelAlgorithms() {
+    cout << "Test parallel algorithms" << endl;
+    ThreadPool pool(3);
+    const ParallelOptions options{1, &pool};
+    const size_t size = 100000;
+
+    SimpleVector<int> v(size);
+    iota(v.begin(), v.end(), 0);
+    ParallelForEach(v, [](int& x) { x *= 2; }, options);
+    for (size_t i = 0; i < size; ++i) {
+        assert(v[i] == static_cast<int>(2 * i));
+    }
+
+    SimpleVector<long long> squares(size);
+    assert(ParallelTransform(v, squares.begin(), [](int x) { return 1LL * x * x; }, options) == squares.end());
+    assert(squares[size - 1] == 1LL * v[size - 1] * v[size - 1]);
+
+    assert(ParallelReduce(squares, 0LL, plus<>(), options) == accumulate(squares.begin(), squares.end(), 0LL));
+    // порядок кусков сохраняется, поэтому достаточно ассоциативности
+    SimpleVector<string> words(1000, "ab");
+    assert(ParallelReduce(words, string(), plus<>(), options).size() == 2000);
+    // короткий диапазон считается на месте и даже не трогает пул
+    assert(ParallelReduce(v.begin(), v.begin() + 3, 0) == 0 + 2 + 4);
+    // пустой диапазон без порога возвращает init
+    assert(ParallelReduce(v.begin(), v.begin(), 7, plus<>(), ParallelOptions{0, &pool}) == 7);
+
+    SimpleVector<unsigned> data(size);
+    unsigned state = 12345;
+    for (auto& x : data) {
+        state = state * 1103515245u + 12345u;
+        x = state >> 8;
+    }
+    vector<unsigned> expected(data.begin(), data.end());
+    sort(expected.begin(), expected.end(), greater<>());
+    ParallelSort(data, greater<>(), options);
+    assert(equal(data.begin(), data.end(), expected.begin()));
+
+    // вложенные вызовы из задач пула не блокируются
+    vector<SimpleVector<int>> parts(8, SimpleVector<int>(1000));
+    pool.ParallelFor(parts.size(), [&](size_t i) {
+        iota(parts[i].begin(), parts[i].end(), 0);
+        ParallelSort(parts[i], greater<>(), options);
+    });
+    for (const auto& part : parts) {
+        assert(part[0] == 999 && part[999] == 0);
+    }
+
+    try {
+        ParallelForEach(v, [](int x) {
+            if (x == 1000) {
+                throw runtime_error("stop");
+            }
+        }, options);
+        assert(false);
+    } catch (const runtime_error& e) {
+        assert(string(e.what()) == "stop");
+    }
+    cout << "Done!" << endl << endl;
+}
+
+// Копирование бросает исключение, когда заканчивается общий запас копий; счётчики атомарны,
+// потому что копии создаются из нескольких потоков
+class FragileCopy {
+public:
+    static inline atomic<int> alive = 0;
+    static inline atomic<int> copies_left = 0;
+
+    FragileCopy() {
+        ++alive;
+    }
+    FragileCopy(const FragileCopy&) {
+        if (--copies_left < 0) {
+            throw runtime_error("copy failed");
+        }
+        ++alive;
+    }
+    FragileCopy& operator=(const FragileCopy&) = default;
+    ~FragileCopy() {
+        --alive;
+    }
+};
+
+void TestParallelConstruction() {
+    cout << "Test parallel construction" << endl;
+    ThreadPool pool(3);
+    const ParallelOptions options{1, &pool};
+    const size_t size = 300000;
+
+    auto zeros = ParallelMakeVector<double>(size, options);
+    assert(zeros.GetSize() == size && zeros.GetCapacity() == size);
+    assert(all_of(zeros.begin(), zeros.end(), [](double x) { return x == 0.0; }));
+
+    auto filled = ParallelMakeVector<int>(size, 7, options);
+    assert(filled.GetSize() == size && count(filled.begin(), filled.end(), 7) == static_cast<ptrdiff_t>(size));
+    ParallelFill(filled, 9, options);
+    assert(count(filled.begin(), filled.end(), 9) == static_cast<ptrdiff_t>(size));
+
+    SimpleVector<string> words(1000, "word");
+    words[999] = "last";
+    const SimpleVector<string> copy = ParallelCopy(words, options);
+    assert(copy == words);
+    assert(ParallelMakeVector<int>(0, options).IsEmpty());
+
+    {
+        const FragileCopy value;
+        FragileCopy::copies_left = 5000;
+        try {
+            ParallelMakeVector<FragileCopy>(10000, value, options);
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        // уже созданные куски разрушены
+        assert(FragileCopy::alive == 1);
+        FragileCopy::copies_left = 10000;
+        auto ok = ParallelMakeVector<FragileCopy>(10000, value, options);
+        assert(FragileCopy::alive == 10001);
+    }
+    assert(FragileCopy::alive == 0);
+    cout << "Done!" << endl << endl;
+}
+
+void TestAlignedStorage() {
+    cout << "Test aligned storage" << endl;
+    const auto is_aligned = [](const void* p, size_t align) {
+        return reinterpret_cast<uintptr_t>(p) % align == 0;
+    };
+    {
+        AlignedSimpleVector<float> v(10, 1.0f);
+        assert(is_aligned(v.Data(), 64));
+        // 10 float занимают 40 байт, вместимость доходит до целого 64-байтового вектора
+        assert(v.GetCapacity() == 16);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack(static_cast<float>(i));
+            assert(is_aligned(v.Data(), 64) && v.GetCapacity() * sizeof(float) % 64 == 0);
+        }
+        v.ShrinkToFit();
+        assert(is_aligned(v.Data(), 64) && v.GetCapacity() == 112);
+    }
+    {
+        AlignedSimpleVector<double, 32> v = {1.0, 2.0, 3.0};
+        assert(is_aligned(v.Data(), 32) && v.GetCapacity() == 4);
+        AlignedSimpleVector<double, 32> copy(v);
+        assert(copy == v && is_aligned(copy.Data(), 32));
+    }
+    {
+        // размер элемента не делит выравнивание: блок кратен 64 байтам, а вместимость -
+        // только целые элементы в нём
+        struct Rgb {
+            unsigned char r, g, b;
+        };
+        AlignedSimpleVector<Rgb> v(1);
+        assert(is_aligned(v.Data(), 64) && v.GetCapacity() == 21);
+        assert(v.GetCapacity() * sizeof(Rgb) % 64 != 0);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+// Сравнивает быстрые пути с обычными алгоритмами на всех длинах и позициях различия
+template <typename Type>
+void CheckCompareAndSearch() {
+    for (size_t size = 0; size < 40; ++size) {
+        SimpleVector<Type> v(size);
+        for (size_t i = 0; i < size; ++i) {
+            v[i] = static_cast<Type>(i % 7);
+        }
+        for (size_t i = 0; i < size; ++i) {
+            for (const Type delta : {static_cast<Type>(1), static_cast<Type>(-1)}) {
+                SimpleVector<Type> other(v);
+                other[i] = static_cast<Type>(other[i] + delta);
+                assert(!(v == other) && v != other);
+                assert((v < other) == lexicographical_compare(v.begin(), v.end(), other.begin(), other.end()));
+                assert((other < v) == lexicographical_compare(other.begin(), other.end(), v.begin(), v.end()));
+            }
+        }
+        SimpleVector<Type> longer(v);
+        longer.PushBack(Type{});
+        assert(v == SimpleVector<Type>(v) && v < longer && !(longer < v));
+
+        for (int value = -1; value < 8; ++value) {
+            const Type needle = static_cast<Type>(value);
+            assert(v.Find(needle) == find(v.begin(), v.end(), needle));
+            assert(v.Count(needle) == static_cast<size_t>(count(v.begin(), v.end(), needle)));
+            assert(v.Contains(needle) == (find(v.begin(), v.end(), needle) != v.end()));
+        }
+    }
+}
+
+void TestCompareAndSearch() {
+    cout << "Test compare and search" << endl;
+    CheckCompareAndSearch<uint8_t>();
+    CheckCompareAndSearch<int8_t>();
+    CheckCompareAndSearch<int16_t>();
+    CheckCompareAndSearch<int32_t>();
+    CheckCompareAndSearch<uint32_t>();
+    CheckCompareAndSearch<int64_t>();
+    CheckCompareAndSearch<double>();
+    {
+        // знаковые элементы упорядочены по значению, а не по байтам
+        const SimpleVector<int8_t> negative = {-1};
+        const SimpleVector<int8_t> positive = {1};
+        assert(negative < positive);
+        const SimpleVector<int32_t> big = {0x100};
+        const SimpleVector<int32_t> small = {0xFF};
+        assert(small < big);
+    }
+    {
+        const SimpleVector<string> v = {"a", "b", "a"};
+        assert(v.Count("a") == 2 && v.Find("b") == v.begin() + 1 && !v.Contains("c"));
+        SimpleVector<double> nan = {0.0, numeric_limits<double>::quiet_NaN()};
+        assert(!(nan == nan) && nan.Count(0.0) == 1);
+        const SimpleVector<bool> flags = {true, false, true, true};
+        assert(flags.Count(true) == 3 && flags.Find(false) == flags.begin() + 1);
+        SimpleVector<int> ints = {1, 2, 3};
+        *ints.Find(2) = 5;
+        assert((ints == SimpleVector<int>{1, 5, 3}));
+    }
+    {
+        SmallSimpleVector<uint8_t, 4> a = {1, 2, 3};
+        SmallSimpleVector<uint8_t, 4> b = {1, 2, 4};
+        assert(a < b && a != b);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+// Преобразуется в Counted с исключением
+struct ThrowingCounted {
+    operator Counted() const {
+        throw runtime_error("no value");
+    }
+};
+
+void TestSoAVector() {
+    cout << "Test SoAVector" << endl;
+    {
+        SoAVector<int, double, string> v;
+        assert(v.IsEmpty() && v.GetCapacity() == 0);
+        for (int i = 0; i < 100; ++i) {
+            v.PushBack({i, i * 0.5, to_string(i)});
+        }
+        v.EmplaceBack(100, 50.0, "100");
+        assert(v.GetSize() == 101 && v.GetCapacity() >= 101);
+
+        // столбцы лежат подряд
+        const span<int> ids = v.Column<0>();
+        assert(ids.size() == 101 && &ids[1] == &ids[0] + 1);
+        assert(accumulate(ids.begin(), ids.end(), 0) == 5050);
+        assert(v.Get<2>(42) == "42" && get<1>(v[10]) == 5.0);
+
+        // строка - кортеж ссылок на поля
+        auto [id, price, name] = v[3];
+        price = 7.5;
+        name = "three";
+        assert(id == 3 && v.Get<1>(3) == 7.5 && v.Get<2>(3) == "three");
+
+        double total = 0;
+        for (auto [i, p, s] : v) {
+            total += p;
+            i = -i;
+        }
+        assert(v.Get<0>(5) == -5 && total > 0);
+        assert(v.end() - v.begin() == 101 && (v.begin() + 3)[0] == v[3]);
+        static_assert(random_access_iterator<SoAVector<int, double>::Iterator>);
+
+        SoAVector<int, double, string> copy(v);
+        assert(copy == v);
+        copy.PopBack();
+        assert(copy != v && copy.GetSize() == 100);
+        SoAVector<int, double, string> moved(move(copy));
+        assert(copy.IsEmpty() && moved.GetSize() == 100);
+        moved.swap(v);
+        assert(v.GetSize() == 100 && moved.GetSize() == 101);
+        try {
+            v.At(100);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+    }
+    {
+        // аргумент, ссылающийся на собственный элемент, переживает перевыделение
+        SoAVector<string, int> v = {{"a", 1}};
+        while (v.GetSize() < v.GetCapacity()) {
+            v.EmplaceBack("x", 0);
+        }
+        v.EmplaceBack(v.Get<0>(0), v.Get<1>(0));
+        assert(v.Get<0>(v.GetSize() - 1) == "a" && v.Get<1>(v.GetSize() - 1) == 1);
+    }
+    {
+        // исключение в поле строки разрушает уже созданные поля той же строки
+        SoAVector<Counted, Counted> v;
+        v.Reserve(4);
+        v.EmplaceBack(1, 2);
+        try {
+            v.EmplaceBack(Counted(3), ThrowingCounted());
+        } catch (const runtime_error&) {
+        }
+        assert(v.GetSize() == 1 && Counted::alive == 2);
+        for (int i = 0; i < 20; ++i) {
+            v.EmplaceBack(i, i);
+        }
+        assert(Counted::alive == 42 && v.Get<1>(20).GetValue() == 19);
+    }
+    assert(Counted::alive == 0);
+    cout << "Done!" << endl << endl;
+}
+
+struct Record {
+    int64_t id;
+    double price;
+};
+
+void TestMmapVector() {
+    cout << "Test mmap vector" << endl;
+    const string path =
+            (filesystem::temp_directory_path() / ("simple_vector_mmap_" + to_string(::getpid()) + ".bin")).string();
+    filesystem::remove(path);
+    {
+        MmapSimpleVector<Record> v(path);
+        assert(v.IsEmpty() && v.IsWritable());
+        for (int i = 0; i < 10000; ++i) {
+            v.PushBack({i, i * 0.25});
+        }
+        v.EmplaceBack(v[0]);
+        assert(v.GetSize() == 10001 && v.GetCapacity() >= 10001 && v[10000].id == 0);
+        v.Insert(v.begin(), Record{-1, -1.0});
+        v.Erase(v.end() - 1);
+        v.Advise(MmapAccess::kSequential);
+        v.Sync();
+    }
+    assert(filesystem::file_size(path) == 10001 * sizeof(Record));
+    {
+        const MmapSimpleVector<Record> v(path, MmapMode::kReadOnly);
+        assert(v.GetSize() == 10001 && !v.IsWritable());
+        assert(v[0].id == -1 && v[1].id == 0 && v[10000].id == 9999 && v.At(10000).price == 9999 * 0.25);
+        v.Advise(MmapAccess::kRandom);
+        // второе отображение того же файла видит те же данные
+        MmapSimpleVector<Record> writer(path);
+        writer[5].price = 42.0;
+        assert(v[5].price == 42.0);
+        writer.Resize(20000);
+        assert(writer[19999].id == 0 && writer[19999].price == 0.0);
+        writer.Resize(10);
+        writer.ShrinkToFit();
+        assert(writer.GetCapacity() == 10);
+    }
+    {
+        MmapSimpleVector<Record> readonly(path, MmapMode::kReadOnly);
+        assert(readonly.GetSize() == 10);
+        try {
+            readonly.PushBack({0, 0.0});
+            assert(false);
+        } catch (const logic_error&) {
+        }
+        MmapSimpleVector<Record> moved(move(readonly));
+        assert(moved.GetSize() == 10 && readonly.IsEmpty());
+    }
+    {
+        MmapSimpleVector<int> ints(path + ".ints");
+        const int values[] = {3, 1, 2};
+        ints.Append(begin(values), end(values));
+        ints.Clear();
+        ints.PushBack(7);
+    }
+    {
+        const MmapSimpleVector<int> ints(path + ".ints", MmapMode::kReadOnly);
+        assert(ints.GetSize() == 1 && ints[0] == 7);
+    }
+    try {
+        MmapSimpleVector<int> missing(path + ".missing", MmapMode::kReadOnly);
+        assert(false);
+    } catch (const system_error&) {
+    }
+    filesystem::remove(path);
+    filesystem::remove(path + ".ints");
+    cout << "Done!" << endl << endl;
+}
+
+void TestSerialization() {
+    cout << "Test serialization" << endl;
+    SimpleVector<Record> records;
+    for (int i = 0; i < 1000; ++i) {
+        records.PushBack({i, i * 1.5});
+    }
+    {
+        stringstream stream;
+        WriteTo(records, stream);
+        WriteTo(SimpleVector<int>(), stream);
+        assert(stream.str().size() == sizeof(SerializedVectorHeader) * 2 + 1000 * sizeof(Record));
+
+        SimpleVector<Record> restored = {{7, 7.0}};
+        ReadFrom(restored, stream);
+        assert(restored.GetSize() == 1000 && restored.GetCapacity() == 1000);
+        assert(restored[999].id == 999 && restored[999].price == 999 * 1.5);
+        SimpleVector<int> empty = {1};
+        ReadFrom(empty, stream);
+        assert(empty.IsEmpty());
+    }
+    {
+        // неверный формат не меняет вектор
+        stringstream stream;
+        WriteTo(records, stream);
+        SimpleVector<int64_t> other = {1, 2};
+        try {
+            ReadFrom(other, stream);
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        assert(other.GetSize() == 2);
+
+        const string bytes = stream.str();
+        stringstream truncated(bytes.substr(0, bytes.size() - 1));
+        SimpleVector<Record> partial;
+        try {
+            ReadFrom(partial, truncated);
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        assert(partial.IsEmpty());
+    }
+    {
+        int fds[2];
+        [[maybe_unused]] const int result = ::pipe(fds);
+        assert(result == 0);
+        SimpleVector<uint16_t> small = {1, 2, 3};
+        WriteTo(small, fds[1]);
+        ::close(fds[1]);
+        SimpleVector<uint16_t> restored;
+        ReadFrom(restored, fds[0]);
+        ::close(fds[0]);
+        assert(restored == small);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestConcurrentVector() {
+    cout << "Test concurrent vector" << endl;
+    {
+        ConcurrentSimpleVector<int> v;
+        const int threads = 4;
+        const int per_thread = 20000;
+        vector<thread> producers;
+        for (int t = 0; t < threads; ++t) {
+            producers.emplace_back([&v, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    v.PushBack(t * per_thread + i);
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        assert(v.GetSize() == threads * per_thread);
+
+        SimpleVector<int> frozen = v.Freeze();
+        assert(v.IsEmpty() && frozen.GetSize() == threads * per_thread);
+        sort(frozen.begin(), frozen.end());
+        for (int i = 0; i < threads * per_thread; ++i) {
+            assert(frozen[i] == i);
+        }
+    }
+    {
+        // читатель видит только сконструированные элементы, пока производители добавляют
+        ConcurrentSimpleVector<string> v;
+        atomic<bool> done = false;
+        thread reader([&] {
+            while (!done.load()) {
+                const size_t size = v.GetSize();
+                for (size_t i = size >= 64 ? size - 64 : 0; i < size; ++i) {
+                    assert(!v[i].empty());
+                }
+            }
+        });
+        vector<thread> producers;
+        for (int t = 0; t < 3; ++t) {
+            producers.emplace_back([&v] {
+                for (int i = 0; i < 5000; ++i) {
+                    v.PushBack(to_string(i));
+                }
+            });
+        }
+        for (auto& producer : producers) {
+            producer.join();
+        }
+        done = true;
+        reader.join();
+        assert(v.GetSize() == 15000);
+    }
+    {
+        // ссылки не инвалидируются ростом
+        ConcurrentSimpleVector<string> v;
+        string& first = v.EmplaceBack("first");
+        for (int i = 0; i < 1000; ++i) {
+            v.PushBack(to_string(i));
+        }
+        assert(&first == &v[0] && first == "first" && v[1000] == "999");
+        const SimpleVector<string> frozen = v.Freeze();
+        assert(frozen.GetSize() == 1001 && frozen[0] == "first" && frozen[1000] == "999");
+        v.PushBack("again");
+        assert(v.GetSize() == 1 && v[0] == "again");
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestShardedAppender() {
+    cout << "Test sharded appender" << endl;
+    ThreadPool pool(3);
+    const ParallelOptions options{1, &pool};
+    ShardedAppender<string> appender;
+    SimpleVector<string> merged = {"existing"};
+    for (int round = 0; round < 2; ++round) {
+        const int threads = 6;
+        const int per_thread = 1000;
+        vector<thread> workers;
+        for (int t = 0; t < threads; ++t) {
+            workers.emplace_back([&appender, t] {
+                for (int i = 0; i < per_thread; ++i) {
+                    appender.PushBack(to_string(t * per_thread + i));
+                }
+            });
+        }
+        for (auto& worker : workers) {
+            worker.join();
+        }
+        assert(appender.GetSize() == threads * per_thread);
+        appender.MergeInto(merged, options);
+        assert(appender.GetSize() == 0);
+        assert(merged.GetSize() == static_cast<size_t>(1 + (round + 1) * threads * per_thread));
+    }
+    assert(merged[0] == "existing");
+    sort(merged.begin() + 1, merged.end(), [](const string& a, const string& b) { return stoi(a) < stoi(b); });
+    for (int i = 0; i < 6000; ++i) {
+        assert(merged[1 + 2 * i] == to_string(i) && merged[2 + 2 * i] == to_string(i));
+    }
+
+    // шарды текущего потока и последовательное слияние
+    ShardedAppender<int> local;
+    local.PushBack(1);
+    local.EmplaceBack(2);
+    assert(local.GetShardCount() == 1 && local.Local().GetSize() == 2);
+    SimpleVector<int> ints;
+    local.MergeInto(ints);
+    assert((ints == SimpleVector<int>{1, 2}));
+
+    // повторные слияния растят вместимость по политике роста, а не ровно под размер
+    size_t reallocations = 0;
+    for (int round = 0; round < 1000; ++round) {
+        const size_t capacity = ints.GetCapacity();
+        local.PushBack(round);
+        local.MergeInto(ints);
+        reallocations += ints.GetCapacity() != capacity ? 1 : 0;
+    }
+    assert(ints.GetSize() == 1002 && ints[1001] == 999 && reallocations < 20);
+    cout << "Done!" << endl << endl;
+}
+
+void TestCowVector() {
+    cout << "Test copy-on-write vector" << endl;
+    CowSimpleVector<string> original = {"a", "b", "c"};
+    assert(!original.IsShared());
+    const CowSimpleVector<string> snapshot = original;
+    assert(original.IsShared() && snapshot.IsShared());
+    assert(original.Read().Data() == snapshot.Read().Data());
+    assert(original == snapshot);
+
+    // первое изменение клонирует буфер, снимок не меняется
+    original.PushBack("d");
+    assert(!original.IsShared() && !snapshot.IsShared());
+    assert(original.Read().Data() != snapshot.Read().Data());
+    assert(original.GetSize() == 4 && snapshot.GetSize() == 3);
+    assert(snapshot[2] == "c" && original[3] == "d");
+
+    // собственный буфер изменяется на месте
+    const string* data = original.Read().Data();
+    original[0] = "z";
+    original.Erase(original.cbegin() + 1);
+    assert(original.Read().Data() == data);
+    assert((original.Read() == SimpleVector<string>{"z", "c", "d"}));
+    assert(snapshot < original);
+
+    // неконстантный доступ через копию тоже отделяет её
+    CowSimpleVector<string> copy = snapshot;
+    copy.At(0) = "x";
+    assert(snapshot.At(0) == "a" && copy.At(0) == "x");
+    try {
+        copy.At(3);
+        assert(false);
+    } catch (const out_of_range&) {
+    }
+
+    // Clear отпускает общий буфер, не копируя его
+    CowSimpleVector<string> cleared = snapshot;
+    cleared.Clear();
+    assert(cleared.IsEmpty() && cleared.GetCapacity() == 0 && snapshot.GetSize() == 3);
+    cleared.EmplaceBack(3, 'q');
+    assert(cleared[0] == "qqq");
+
+    // выданная изменяемая ссылка не должна менять последующие копии
+    CowSimpleVector<int> referenced = {1, 2, 3};
+    int& first = referenced[0];
+    const CowSimpleVector<int> after_reference = referenced;
+    CowSimpleVector<int> assigned;
+    assigned = referenced;
+    first = 42;
+    assert(referenced[0] == 42 && after_reference[0] == 1 && assigned.Read()[0] == 1);
+    assert(!referenced.IsShared() && !after_reference.IsShared());
+
+    CowSimpleVector<int> from_vector(SimpleVector<int>{1, 2, 3});
+    CowSimpleVector<int> empty;
+    assert(empty.IsEmpty() && empty.begin() == empty.end());
+    empty = from_vector;
+    assert(empty == from_vector && empty.IsShared());
+    from_vector = CowSimpleVector<int>();
+    assert(!empty.IsShared() && empty.GetSize() == 3);
+
+    // копии читают и изменяются в разных потоках
+    const CowSimpleVector<int> shared(1000, 7);
+    vector<thread> workers;
+    for (int t = 0; t < 4; ++t) {
+        workers.emplace_back([shared, t] {
+            CowSimpleVector<int> local = shared;
+            local[0] = t;
+            assert(local[0] == t && local[999] == 7);
+            assert(accumulate(shared.begin(), shared.end(), 0) == 7000);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    assert(!shared.IsShared() && shared[0] == 7);
+    cout << "Done!" << endl << endl;
+}
+
+void TestPersistentVector() {
+    cout << "Test persistent vector" << endl;
+    // построение через transient и обмен с SimpleVector
+    SimpleVector<int> source(5000);
+    iota(source.begin(), source.end(), 0);
+    const PersistentVector<int> base(source);
+    assert(base.GetSize() == 5000 && base[0] == 0 && base[4999] == 4999);
+    assert(base.ToSimpleVector() == source);
+    assert(equal(base.begin(), base.end(), source.begin()));
+
+    // версии делят узлы и не влияют друг на друга
+    const PersistentVector<int> edited = base.Set(1234, -1).PushBack(5000);
+    assert(base[1234] == 1234 && base.GetSize() == 5000);
+    assert(edited[1234] == -1 && edited.GetSize() == 5001 && edited[5000] == 5000);
+    assert(edited.PopBack().PopBack().GetSize() == 4999 && edited.GetSize() == 5001);
+    const PersistentVector<int> copy = base;
+    assert(copy.SharesWith(base) && copy == base && edited != base);
+    try {
+        base.At(5000);
+        assert(false);
+    } catch (const out_of_range&) {
+    }
+
+    const PersistentVector<int> middle = base.Slice(1000, 3100);
+    assert(middle.GetSize() == 2100 && middle[0] == 1000 && middle[2099] == 3099);
+    assert(base.Slice(10, 10).IsEmpty());
+    const PersistentVector<int> joined = middle.Concat(base.Slice(0, 40)).Concat(middle);
+    assert(joined.GetSize() == 4240);
+    assert(joined[2099] == 3099 && joined[2100] == 0 && joined[2139] == 39 && joined[2140] == 1000);
+    assert(joined.Slice(2100, 2140) == base.Slice(0, 40));
+    assert(joined.PushBack(7)[4240] == 7);
+
+    auto transient = joined.Transient();
+    for (int i = 0; i < 100; ++i) {
+        transient.PushBack(i);
+    }
+    transient.Set(0, 42);
+    transient.PopBack();
+    const PersistentVector<int> batch = std::move(transient).Persistent();
+    assert(batch.GetSize() == 4339 && batch[0] == 42 && batch[4338] == 98);
+    assert(joined[0] == 1000 && joined.GetSize() == 4240);
+
+    // повторное добавление в начало и склейка кусков среднего размера с обеих сторон
+    // не вырождают дерево
+    PersistentVector<int> small;
+    for (int i = 0; i < 33; ++i) {
+        small = std::move(small).PushBack(i);
+    }
+    PersistentVector<int> prepended;
+    vector<int> expected_prepended;
+    for (int round = 0; round < 500; ++round) {
+        prepended = small.Concat(prepended);
+        expected_prepended.insert(expected_prepended.begin(), small.begin(), small.end());
+    }
+    assert(prepended.GetSize() == expected_prepended.size());
+    for (size_t i = 0; i < expected_prepended.size(); ++i) {
+        assert(prepended[i] == expected_prepended[i]);
+    }
+    assert(equal(prepended.begin(), prepended.end(), expected_prepended.begin(), expected_prepended.end()));
+
+    PersistentVector<int> mixed;
+    vector<int> expected_mixed;
+    unsigned seed = 7;
+    for (int round = 0; round < 400; ++round) {
+        seed = seed * 1103515245u + 12345u;
+        const int length = static_cast<int>(seed >> 16) % 300;
+        auto piece_builder = PersistentVector<int>().Transient();
+        for (int i = 0; i < length; ++i) {
+            piece_builder.PushBack(round * 1000 + i);
+        }
+        const PersistentVector<int> piece = std::move(piece_builder).Persistent();
+        if (round % 2 == 0) {
+            mixed = piece.Concat(mixed);
+            expected_mixed.insert(expected_mixed.begin(), piece.begin(), piece.end());
+        } else {
+            mixed = mixed.Concat(piece);
+            expected_mixed.insert(expected_mixed.end(), piece.begin(), piece.end());
+        }
+    }
+    assert(mixed.GetSize() == expected_mixed.size());
+    for (size_t i = 0; i < expected_mixed.size(); ++i) {
+        assert(mixed[i] == expected_mixed[i]);
+    }
+    assert(equal(mixed.begin(), mixed.end(), expected_mixed.begin(), expected_mixed.end()));
+
+    // элементы с нетривиальным копированием
+    PersistentVector<string> strings = {"a", "b"};
+    const PersistentVector<string> old = strings;
+    for (int i = 0; i < 100; ++i) {
+        strings = std::move(strings).PushBack(to_string(i));
+    }
+    strings = strings.Slice(1, 101);
+    assert(strings[0] == "b" && strings[99] == "98" && old.GetSize() == 2);
+    SimpleVector<string> moved = {"x", "y"};
+    const PersistentVector<string> taken(std::move(moved));
+    assert(taken.GetSize() == 2 && taken[1] == "y" && moved.IsEmpty());
+    cout << "Done!" << endl << endl;
+}
+
+void TestSegmentedVector() {
+    cout << "Test segmented vector" << endl;
+    SegmentedVector<string, allocator<string>, 4> v;
+    v.PushBack("first");
+    const string* first = &v[0];
+    for (int i = 1; i < 10; ++i) {
+        v.EmplaceBack(to_string(i));
+    }
+    // рост добавляет блоки, а элементы остаются на месте
+    assert(v.GetSize() == 10 && v.GetCapacity() == 12 && v.GetBlockCount() == 3);
+    assert(&v[0] == first && v[0] == "first" && v[9] == "9");
+    v.PushBack(v[0]);
+    v.PushBack(v[1]);
+    assert(v.GetBlockCount() == 3 && v[10] == "first" && v[11] == "1");
+    v.PushBack(v[2]);
+    assert(v.GetBlockCount() == 4 && v[12] == "2");
+    try {
+        v.At(13);
+        assert(false);
+    } catch (const out_of_range&) {
+    }
+
+    SegmentedVector<string, allocator<string>, 4> copy = v;
+    assert(copy == v);
+    copy.PopBack();
+    copy.Resize(5);
+    assert(copy.GetSize() == 5 && copy[4] == "4" && copy.GetBlockCount() == 4);
+    copy.ShrinkToFit();
+    assert(copy.GetBlockCount() == 2 && copy != v);
+    copy.Resize(7);
+    assert(copy[6].empty());
+    sort(v.begin(), v.end());
+    assert(v[0] == "1" && v[12] == "first");
+
+    // сборка в непрерывный вектор освобождает блоки
+    SimpleVector<string> compact = v.Compact();
+    assert(compact.GetSize() == 13 && compact[0] == "1" && compact[12] == "first");
+    assert(v.IsEmpty() && v.GetBlockCount() == 0);
+
+    SegmentedVector<int> ints(100000, 3);
+    assert(ints.GetBlockCount() == (100000 + ints.kBlockSize - 1) / ints.kBlockSize);
+    assert(accumulate(ints.begin(), ints.end(), 0) == 300000);
+    const SimpleVector<int> flat = ints.Compact();
+    assert(flat.GetSize() == 100000 && flat[99999] == 3 && ints.IsEmpty());
+    const SegmentedVector<int> small = {1, 2, 3};
+    assert(small.GetBlockCount() == 1 && *(small.begin() + 2) == 3);
+    cout << "Done!" << endl << endl;
+}
+
+void TestGapBuffer() {
+    cout << "Test gap buffer" << endl;
+    GapBuffer<string> text = {"a", "b", "c"};
+    assert(text.GetSize() == 3 && text.GetGapPosition() == 3);
+    // вставки у курсора не сдвигают хвост
+    auto it = text.Insert(text.cbegin() + 1, "x");
+    assert(*it == "x" && text.GetGapPosition() == 2);
+    text.Insert(text.cbegin() + 2, "y");
+    assert(text.GetGapPosition() == 3);
+    assert((vector<string>(text.begin(), text.end()) == vector<string>{"a", "x", "y", "b", "c"}));
+    assert(text.BeforeGap().size() == 3 && text.AfterGap().size() == 2 && text.AfterGap()[0] == "b");
+    text.Erase(text.cbegin() + 2);
+    assert(text.GetGapPosition() == 2 && text[2] == "b");
+    text.Insert(text.cbegin() + 4, text[0]);
+    assert(text.GetSize() == 5 && text[4] == "a" && text.At(3) == "c");
+
+    // PushFront держит разрыв в начале
+    text.PushFront("f1");
+    text.PushFront("f0");
+    assert(text.GetGapPosition() == 0 && text[0] == "f0" && text[1] == "f1");
+    text.PushBack("end");
+    assert(text[text.GetSize() - 1] == "end");
+    text.PopFront();
+    text.PopBack();
+    assert(text[0] == "f1" && text.GetSize() == 6);
+    try {
+        text.At(6);
+        assert(false);
+    } catch (const out_of_range&) {
+    }
+
+    GapBuffer<string> copy = text;
+    assert(copy == text);
+    text.MoveGap(3);
+    assert(copy == text && text.GetGapPosition() == 3);
+    sort(copy.begin(), copy.end());
+    assert(copy[0] == "a" && copy != text);
+
+    GapBuffer<int> numbers;
+    for (int i = 0; i < 1000; ++i) {
+        numbers.PushFront(i);
+    }
+    assert(numbers.GetSize() == 1000 && numbers[0] == 999 && numbers[999] == 0);
+    numbers.Clear();
+    assert(numbers.IsEmpty() && numbers.GetCapacity() >= 1000);
+    cout << "Done!" << endl << endl;
+}
+
+void TestSimpleSpan() {
+    cout << "Test simple span" << endl;
+    SimpleVector<int> numbers(100);
+    iota(numbers.begin(), numbers.end(), 0);
+    SimpleSpan span(numbers);
+    assert(span.Get() == numbers.Data() && span.GetSize() == 100);
+
+    // срезы без копирования
+    const SimpleSpan<int> middle = span.Subspan(10, 20);
+    assert(middle.GetSize() == 20 && middle[0] == 10 && middle.begin() == numbers.Data() + 10);
+    assert(middle.First(5).Last(2)[0] == 13 && span.Subspan(95).GetSize() == 5 && span.Last(1)[0] == 99);
+    middle[0] = -10;
+    assert(numbers[10] == -10);
+    assert(middle.Contains(15) && middle.Find(15) - middle.begin() == 5 && middle.Count(15) == 1);
+    try {
+        middle.At(20);
+        assert(false);
+    } catch (const out_of_range&) {
+    }
+
+    // виды из разных контейнеров и сравнения между ними
+    const SimpleVector<int> copy = numbers;
+    const SimpleSpan<const int> readonly = copy;
+    SimpleSpan<const int> converted = span;
+    assert(readonly == converted && !(readonly < converted) && readonly <= converted);
+    StaticVector<int, 4> small = {1, 2, 3};
+    const SimpleSpan<int> small_span = small;
+    assert(small_span.GetSize() == 3 && small_span != readonly && small_span > readonly);
+    ArrayPtr<int> raw(8);
+    raw[0] = 1;
+    raw[1] = 2;
+    assert((SimpleSpan<const int>(raw, 2) == SimpleSpan<const int>(small.begin(), 2)));
+    assert(SimpleSpan<int>().IsEmpty());
+
+    // параллельные алгоритмы и сериализация принимают виды
+    ThreadPool pool(2);
+    const ParallelOptions options{1, &pool};
+    ParallelFill(span.Subspan(50, 10), 7, options);
+    assert(numbers[49] == 49 && numbers[50] == 7 && numbers[59] == 7 && numbers[60] == 60);
+    ParallelSort(span.First(10), greater<>(), options);
+    assert(numbers[0] == 9 && numbers[9] == 0 && numbers[10] == -10);
+    assert(ParallelReduce(readonly.Subspan(20, 3), 0, plus<>(), options) == 20 + 21 + 22);
+    const SimpleVector<int> materialized = ParallelCopy(readonly.Subspan(30, 40), options);
+    assert(materialized.GetSize() == 40 && materialized[0] == 30 && materialized[39] == 69);
+
+    stringstream stream;
+    WriteTo(readonly.Subspan(5, 3), stream);
+    SimpleVector<int> restored;
+    ReadFrom(restored, stream);
+    assert((restored == SimpleVector<int>{5, 6, 7}));
+    WriteTo(restored, stream);
+    array<int, 3> target{};
+    ReadFrom(SimpleSpan<int>(target.data(), target.size()), stream);
+    assert((target == array<int, 3>{5, 6, 7}));
+    WriteTo(restored, stream);
+    try {
+        ReadFrom(SimpleSpan<int>(target.data(), 2), stream);
+        assert(false);
+    } catch (const runtime_error&) {
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestHugePages() {
+    cout << "Test huge pages" << endl;
+    // мелкие блоки выделяются как обычно, без округления
+    HugePageAllocator<int> alloc;
+    const auto small = alloc.allocate_at_least(100);
+    assert(small.count == 100);
+    alloc.deallocate(small.ptr, small.count);
+
+    // крупные округляются до целой страницы 2 МиБ и выровнены на неё
+    constexpr size_t kPage = size_t(1) << 21;
+    HugePageSimpleVector<int64_t> numbers;
+    numbers.Reserve(kPage / sizeof(int64_t) + 1);
+    assert(numbers.GetCapacity() == 2 * kPage / sizeof(int64_t));
+    assert(reinterpret_cast<uintptr_t>(numbers.Data()) % kPage == 0);
+    for (int64_t i = 0; i < 1'000'000; ++i) {
+        numbers.PushBack(i);
+    }
+    assert(numbers.GetSize() == 1'000'000 && numbers[999'999] == 999'999);
+    assert(numbers.GetCapacity() * sizeof(int64_t) % kPage == 0);
+    numbers.ShrinkToFit();
+    assert(numbers[123'456] == 123'456);
+
+    // без зарезервированных страниц hugetlbfs явный режим переходит на прозрачные страницы
+    HugePageSimpleVector<int, HugePageMode::kExplicit2MB> explicit_pages(kPage, 7);
+    assert(explicit_pages.GetSize() == kPage && explicit_pages[kPage - 1] == 7);
+    HugePageAllocator<char, HugePageMode::kExplicit2MB> bytes_alloc;
+    assert(bytes_alloc.allocate_at_least(kPage + 1).count == 2 * kPage);
+    bytes_alloc.deallocate(bytes_alloc.allocate(3 * kPage - 1), 3 * kPage - 1);
+
+    // Prefetch только подсказка и за пределами вектора ничего не делает
+    int64_t sum = 0;
+    for (size_t i = 0; i < numbers.GetSize(); i += 4096) {
+        numbers.Prefetch(i + 4096 * 8);
+        numbers.Prefetch(i + 4096 * 8, PrefetchHint::kReadOnce);
+        sum += numbers[i];
+    }
+    numbers.Prefetch(numbers.GetSize(), PrefetchHint::kWrite);
+    SimpleSpan<const int64_t>(numbers).Prefetch(0);
+    assert(sum == 4096 * (244 * 245 / 2));
+    cout << "Done!" << endl << endl;
+}
+
+void TestCheckedMode() {
+    cout << "Test checked mode" << endl;
+    // в обычной сборке итераторы остаются указателями
+    static_assert(detail::kVectorChecksEnabled || is_same_v<SimpleVector<int>::Iterator, int*>);
+    SimpleVector<int> v = {1, 2, 3};
+    v.Reserve(10);
+    // PushBack без перевыделения не трогает уже полученные итераторы
+    auto second = v.begin() + 1;
+    v.PushBack(4);
+    assert(*second == 2 && v.Data() + 1 == &*second);
+
+    if constexpr (detail::kVectorChecksEnabled) {
+        const auto expect_error = [](auto action) {
+            try {
+                action();
+                assert(false);
+            } catch (const CheckedAccessError&) {
+            }
+        };
+        // перевыделение, Insert и Erase делают итераторы недействительными
+        v.Reserve(100);
+        expect_error([&] { (void)*second; });
+        second = v.begin() + 1;
+        v.Insert(v.begin(), 0);
+        expect_error([&] { ++second; });
+        auto first = v.begin();
+        v.Erase(v.begin() + 2);
+        expect_error([&] { (void)(first == v.begin()); });
+
+        // границы проверяются и при NDEBUG
+        const auto end = v.end();
+        expect_error([&] { (void)*end; });
+        expect_error([&] { (void)(end + 1); });
+        expect_error([&] { (void)(v.begin() - 1); });
+        expect_error([&] { (void)v[v.GetSize()]; });
+        SimpleVector<int> empty;
+        expect_error([&] { empty.PopBack(); });
+
+        // итераторы разных векторов не сравниваются, а перемещённый вектор отпускает свои
+        SimpleVector<int> copy = v;
+        expect_error([&] { (void)(v.begin() == copy.begin()); });
+        const auto moved_from = copy.begin();
+        SimpleVector<int> taken = std::move(copy);
+        expect_error([&] { (void)*moved_from; });
+        assert(taken == v);
+
+        // переполнение размера при росте
+        try {
+            v.AppendUninitialized(numeric_limits<size_t>::max(), [](int*, size_t) {});
+            assert(false);
+        } catch (const length_error&) {
+        }
+        assert(v.GetSize() == 4);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+// Аллокатор, бросающий bad_alloc, когда исчерпан общий запас выделений
+template <typename Type>
+struct LimitedAllocator {
+    using value_type = Type;
+
+    static inline size_t budget = numeric_limits<size_t>::max();
+
+    LimitedAllocator() = default;
+    template <typename Other>
+    LimitedAllocator(const LimitedAllocator<Other>&) noexcept {
+    }
+
+    Type* allocate(size_t n) {
+        if (budget == 0) {
+            throw bad_alloc();
+        }
+        --budget;
+        return std::allocator<Type>().allocate(n);
+    }
+    void deallocate(Type* p, size_t n) noexcept {
+        std::allocator<Type>().deallocate(p, n);
+    }
+
+    bool operator==(const LimitedAllocator&) const noexcept {
+        return true;
+    }
+};
+
+void TestFlatSet() {
+    cout << "Test flat set" << endl;
+    FlatSet<int> numbers = {5, 1, 3, 1, 4};
+    assert(numbers.GetSize() == 4 && (numbers.Keys() == SimpleVector<int>{1, 3, 4, 5}));
+    assert(numbers.Contains(3) && !numbers.Contains(2) && numbers.Count(5) == 1);
+    assert(*numbers.LowerBound(2) == 3 && *numbers.UpperBound(3) == 4 && numbers.LowerBound(6) == numbers.end());
+    assert(numbers.Insert(2).second && !numbers.Insert(2).second && *numbers.Insert(0).first == 0);
+    assert(numbers.Erase(4) == 1 && numbers.Erase(4) == 0);
+    assert(*numbers.Erase(numbers.Find(0)) == 1);
+    assert((numbers.Keys() == SimpleVector<int>{1, 2, 3, 5}));
+
+    // пачка ключей: в конец - вставкой диапазона, в середину - одним слиянием
+    const SimpleVector<int> tail = {6, 7, 7, 8};
+    numbers.InsertSorted(tail.begin(), tail.end());
+    assert((numbers.Keys() == SimpleVector<int>{1, 2, 3, 5, 6, 7, 8}));
+    const list<int> middle = {0, 2, 4, 4, 9};
+    numbers.InsertSorted(middle.begin(), middle.end());
+    assert((numbers.Keys() == SimpleVector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9}));
+    numbers.Merge(FlatSet<int>{-1, 5, 10});
+    assert(numbers.GetSize() == 12 && *numbers.begin() == -1 && *(numbers.end() - 1) == 10);
+
+    // сравнение по Compare и сверка с std::set на случайных данных
+    FlatSet<string, greater<>> words = {"b", "c", "a"};
+    assert(*words.begin() == "c" && *words.LowerBound("bb") == "b");
+    FlatSet<int> flat;
+    set<int> expected;
+    uint32_t seed = 1;
+    for (int round = 0; round < 50; ++round) {
+        SimpleVector<int> batch;
+        for (int i = 0; i < 20; ++i) {
+            seed = seed * 1664525u + 1013904223u;
+            batch.PushBack(static_cast<int>(seed >> 24));
+        }
+        sort(batch.begin(), batch.end());
+        flat.InsertSorted(batch.begin(), batch.end());
+        expected.insert(batch.begin(), batch.end());
+        flat.Erase(static_cast<int>(seed >> 25));
+        expected.erase(static_cast<int>(seed >> 25));
+        assert(flat.GetSize() == expected.size() && equal(flat.begin(), flat.end(), expected.begin()));
+    }
+    for (int key = -1; key <= 256; ++key) {
+        assert(flat.Contains(key) == (expected.count(key) == 1));
+        assert(flat.LowerBound(key) - flat.begin() == distance(expected.begin(), expected.lower_bound(key)));
+        assert(flat.UpperBound(key) - flat.begin() == distance(expected.begin(), expected.upper_bound(key)));
+    }
+
+    // нехватка памяти при слиянии не теряет ключи
+    using LimitedSet = FlatSet<int, less<int>, LimitedAllocator<int>>;
+    const LimitedSet original = {1, 3, 5, 7};
+    const SimpleVector<int> odd_batch = {2, 4, 6, 8, 10, 12};
+    for (size_t budget = 0;; ++budget) {
+        LimitedSet limited = original;
+        LimitedAllocator<int>::budget = budget;
+        try {
+            limited.InsertSorted(odd_batch.begin(), odd_batch.end());
+        } catch (const bad_alloc&) {
+            LimitedAllocator<int>::budget = numeric_limits<size_t>::max();
+            assert(limited == original);
+            continue;
+        }
+        LimitedAllocator<int>::budget = numeric_limits<size_t>::max();
+        assert(limited.GetSize() == 10 && *(limited.end() - 1) == 12);
+        break;
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestFlatMap() {
+    cout << "Test flat map" << endl;
+    FlatMap<string, int> ages = {{"bob", 30}, {"alice", 25}, {"bob", 99}};
+    assert(ages.GetSize() == 2 && ages.At("bob") == 30 && (ages.Keys() == SimpleVector<string>{"alice", "bob"}));
+    assert((ages.Values() == SimpleVector<int>{25, 30}));
+    try {
+        ages.At("carol");
+        assert(false);
+    } catch (const out_of_range&) {
+    }
+    ages["carol"] = 41;
+    ++ages["alice"];
+    assert(ages.GetSize() == 3 && ages.At("alice") == 26);
+    assert(!ages.TryEmplace("bob", 1).second && ages.At("bob") == 30);
+    assert(!ages.InsertOrAssign("bob", 31).second && ages.At("bob") == 31);
+    assert(ages.Insert({"dave", 50}).second && (*ages.Find("dave")).second == 50);
+    assert(ages.Find("eve") == ages.end() && ages.Erase("eve") == 0 && ages.Erase("dave") == 1);
+    for (auto [name, age] : ages) {
+        age += 1;
+    }
+    assert(ages.At("carol") == 42);
+    const auto next = ages.Erase(ages.Find("alice"));
+    assert((*next).first == "bob" && ages.GetSize() == 2);
+
+    // столбцы в любом порядке и пачки отсортированных элементов
+    FlatMap<int, string> names(SimpleVector<int>{3, 1, 2}, SimpleVector<string>{"c", "a", "b"});
+    assert((names.Keys() == SimpleVector<int>{1, 2, 3}) && (names.Values() == SimpleVector<string>{"a", "b", "c"}));
+    const SimpleVector<pair<int, string>> batch = {{0, "zero"}, {2, "two"}, {5, "five"}, {5, "again"}};
+    names.InsertSorted(batch.begin(), batch.end());
+    assert((names.Keys() == SimpleVector<int>{0, 1, 2, 3, 5}));
+    assert((names.Values() == SimpleVector<string>{"zero", "a", "b", "c", "five"}));
+    names.Merge(FlatMap<int, string>{{4, "four"}, {6, "six"}});
+    assert(names.GetSize() == 7 && names.At(4) == "four" && (*names.LowerBound(6)).second == "six");
+    assert(names.UpperBound(6) == names.end() && names.Contains(0) && names.Count(7) == 0);
+    try {
+        FlatMap<int, int>(SimpleVector<int>{1, 2}, SimpleVector<int>{1});
+        assert(false);
+    } catch (const invalid_argument&) {
+    }
+
+    // сверка с std::map
+    FlatMap<int, int> flat;
+    map<int, int> expected;
+    uint32_t seed = 7;
+    for (int i = 0; i < 2000; ++i) {
+        seed = seed * 1664525u + 1013904223u;
+        const int key = static_cast<int>(seed >> 23);
+        if (seed & 1) {
+            flat[key] += i;
+            expected[key] += i;
+        } else {
+            assert(flat.Erase(key) == expected.erase(key));
+        }
+    }
+    assert(flat.GetSize() == expected.size());
+    assert(equal(flat.begin(), flat.end(), expected.begin(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first == rhs.first && lhs.second == rhs.second;
+    }));
+
+    // нехватка памяти при слиянии оставляет столбцы согласованными
+    using LimitedMap = FlatMap<int, int, less<int>, LimitedAllocator<int>, LimitedAllocator<int>>;
+    const LimitedMap original = {{1, 10}, {3, 30}, {5, 50}, {7, 70}};
+    const SimpleVector<pair<int, int>> pairs = {{2, 20}, {4, 40}, {6, 60}, {8, 80}, {10, 100}};
+    for (size_t budget = 0;; ++budget) {
+        LimitedMap limited = original;
+        LimitedAllocator<int>::budget = budget;
+        try {
+            limited.InsertSorted(pairs.begin(), pairs.end());
+        } catch (const bad_alloc&) {
+            LimitedAllocator<int>::budget = numeric_limits<size_t>::max();
+            assert(limited.Keys().GetSize() == limited.Values().GetSize() && limited == original);
+            continue;
+        }
+        LimitedAllocator<int>::budget = numeric_limits<size_t>::max();
+        assert(limited.GetSize() == 9 && limited.At(10) == 100 && limited.At(7) == 70);
+        break;
+    }
+    cout << "Done!" << endl << endl;
+}
+
 int main() {
     TestTemporaryObjConstructor();
     TestTemporaryObjOperator();
@@ -158,5 +1886,34 @@ int main() {
     TestNoncopiablePushBack();
     TestNoncopiableInsert();
     TestNoncopiableErase();
+    TestUninitializedStorage();
+    TestAllocator();
+    TestEmplace();
+    TestTriviallyRelocatable();
+    TestGrowthPolicy();
+    TestShrinkToFit();
+    TestRangeInsert();
+    TestRangeErase();
+    TestSmallSimpleVector();
+    TestStaticVector();
+    TestStats();
+    TestParallelAlgorithms();
+    TestParallelConstruction();
+    TestAlignedStorage();
+    TestCompareAndSearch();
+    TestSoAVector();
+    TestMmapVector();
+    TestSerialization();
+    TestConcurrentVector();
+    TestShardedAppender();
+    TestCowVector();
+    TestPersistentVector();
+    TestSegmentedVector();
+    TestGapBuffer();
+    TestSimpleSpan();
+    TestHugePages();
+    TestCheckedMode();
+    TestFlatSet();
+    TestFlatMap();
     return 0;
 }
@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+
+// Аллокатор поверх malloc/realloc/free. Умеет reallocate, поэтому SimpleVector
+// с побайтно переносимыми элементами растёт через std::realloc, часто без копирования
+template <typename Type>
+class MallocAllocator {
+public:
+    using value_type = Type;
+
+    static_assert(alignof(Type) <= alignof(std::max_align_t), "malloc does not guarantee this alignment");
+
+    MallocAllocator() noexcept = default;
+
+    template <typename Other>
+    MallocAllocator(const MallocAllocator<Other>&) noexcept {
+    }
+
+    Type* allocate(size_t n) {
+        void* p = std::malloc(n * sizeof(Type));
+        if (p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<Type*>(p);
+    }
+
+    void deallocate(Type* p, size_t) noexcept {
+        std::free(p);
+    }
+
+    // Содержимое переносится побайтно, поэтому годится только для IsTriviallyRelocatable типов
+    Type* reallocate(Type* p, size_t, size_t new_size) {
+        void* new_p = std::realloc(p, new_size * sizeof(Type));
+        if (new_p == nullptr) {
+            throw std::bad_alloc();
+        }
+        return static_cast<Type*>(new_p);
+    }
+
+    template <typename Other>
+    bool operator==(const MallocAllocator<Other>&) const noexcept {
+        return true;
+    }
+};
@@ -0,0 +1,199 @@
+#pragma once
+
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+// Что будет сделано с элементом после Prefetch: чтение, запись или однократное чтение,
+// после которого строку кеша не нужно держать близко к ядру
+enum class PrefetchHint {
+    kRead,
+    kWrite,
+    kReadOnce,
+};
+
+// Вспомогательные функции для работы с неинициализированной памятью через аллокатор.
+// Если аллокатор не переопределяет construct/destroy, используются алгоритмы из <memory>,
+// которые стандартная библиотека умеет сводить к memmove/memset
+namespace detail {
+
+template <typename Allocator, typename Type, typename = void>
+struct HasCustomConstruct : std::false_type {};
+
+template <typename Allocator, typename Type>
+struct HasCustomConstruct<Allocator, Type,
+        std::void_t<decltype(std::declval<Allocator&>().construct(std::declval<Type*>(), std::declval<Type&&>()))>>
+        : std::true_type {};
+
+template <typename Allocator, typename Type>
+inline constexpr bool kDefaultConstruct = !HasCustomConstruct<Allocator, Type>::value;
+
+// Аллокатор, переопределяющий construct, считаем переопределяющим и destroy
+template <typename Allocator, typename Type>
+inline constexpr bool kDefaultDestroy = kDefaultConstruct<Allocator, Type>;
+
+// Аллокатор может уметь расширять блок на месте или переносить его побайтно (как std::realloc):
+// Type* reallocate(Type* p, size_t old_size, size_t new_size)
+template <typename Allocator, typename = void>
+struct HasReallocate : std::false_type {};
+
+template <typename Allocator>
+struct HasReallocate<Allocator,
+        std::void_t<decltype(std::declval<Allocator&>().reallocate(
+                std::declval<typename std::allocator_traits<Allocator>::pointer>(), size_t(), size_t()))>>
+        : std::true_type {};
+
+// Аллокатор может сообщать реальный размер выделенного блока (класс размера), как в C++23:
+// Result allocate_at_least(size_t n), где у Result есть поля ptr и count >= n
+template <typename Allocator, typename = void>
+struct HasAllocateAtLeast : std::false_type {};
+
+template <typename Allocator>
+struct HasAllocateAtLeast<Allocator, std::void_t<decltype(std::declval<Allocator&>().allocate_at_least(size_t()))>>
+        : std::true_type {};
+
+}  // namespace detail
+
+// Тип можно переносить побайтным копированием без вызова конструктора перемещения и деструктора.
+// Специализируйте для собственных типов-дескрипторов, владеющих ресурсом по указателю
+template <typename Type>
+struct IsTriviallyRelocatable : std::bool_constant<std::is_trivially_copyable_v<Type>> {};
+
+template <typename Type>
+struct IsTriviallyRelocatable<std::unique_ptr<Type>> : std::true_type {};
+
+namespace detail {
+
+// Побайтный перенос допустим, если тип его позволяет и аллокатор не вмешивается в конструирование
+template <typename Allocator, typename Type>
+inline constexpr bool kRelocateBitwise = IsTriviallyRelocatable<Type>::value && kDefaultConstruct<Allocator, Type>;
+
+// Переносит count элементов побайтно, диапазоны могут перекрываться.
+// После вызова исходные элементы считаются несуществующими и не разрушаются
+template <typename Type>
+void RelocateBitwise(Type* first, size_t count, Type* dest) noexcept {
+    if (count != 0) {
+        std::memmove(static_cast<void*>(dest), static_cast<const void*>(first), count * sizeof(Type));
+    }
+}
+
+template <typename Allocator, typename Type, typename... Args>
+void Construct(Allocator& alloc, Type* p, Args&&... args) {
+    if constexpr (kDefaultConstruct<Allocator, Type>) {
+        ::new (static_cast<void*>(p)) Type(std::forward<Args>(args)...);
+    } else {
+        std::allocator_traits<Allocator>::construct(alloc, p, std::forward<Args>(args)...);
+    }
+}
+
+template <typename Allocator, typename Type>
+void Destroy(Allocator& alloc, Type* p) noexcept {
+    if constexpr (kDefaultDestroy<Allocator, Type>) {
+        std::destroy_at(p);
+    } else {
+        std::allocator_traits<Allocator>::destroy(alloc, p);
+    }
+}
+
+template <typename Allocator, typename Type>
+void DestroyN(Allocator& alloc, Type* first, size_t count) noexcept {
+    if constexpr (kDefaultDestroy<Allocator, Type>) {
+        std::destroy_n(first, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            std::allocator_traits<Allocator>::destroy(alloc, first + i);
+        }
+    }
+}
+
+// Конструирует элементы в [dest, dest + count) вызовом make(i), при исключении разрушает уже созданные
+template <typename Allocator, typename Type, typename Make>
+void UninitializedGenerateN(Allocator& alloc, Type* dest, size_t count, Make&& make) {
+    size_t i = 0;
+    try {
+        for (; i < count; ++i) {
+            Construct(alloc, dest + i, make(i));
+        }
+    } catch (...) {
+        DestroyN(alloc, dest, i);
+        throw;
+    }
+}
+
+template <typename Allocator, typename Type>
+void UninitializedValueConstructN(Allocator& alloc, Type* dest, size_t count) {
+    if constexpr (kDefaultConstruct<Allocator, Type>) {
+        std::uninitialized_value_construct_n(dest, count);
+    } else {
+        size_t i = 0;
+        try {
+            for (; i < count; ++i) {
+                std::allocator_traits<Allocator>::construct(alloc, dest + i);
+            }
+        } catch (...) {
+            DestroyN(alloc, dest, i);
+            throw;
+        }
+    }
+}
+
+template <typename Allocator, typename Type>
+void UninitializedFillN(Allocator& alloc, Type* dest, size_t count, const Type& value) {
+    if constexpr (kDefaultConstruct<Allocator, Type>) {
+        std::uninitialized_fill_n(dest, count, value);
+    } else {
+        UninitializedGenerateN(alloc, dest, count, [&value](size_t) -> const Type& {
+            return value;
+        });
+    }
+}
+
+// Копирует [first, last) в неинициализированную память, возвращает указатель за последним созданным элементом
+template <typename Allocator, typename InputIt, typename Type>
+Type* UninitializedCopy(Allocator& alloc, InputIt first, InputIt last, Type* dest) {
+    if constexpr (kDefaultConstruct<Allocator, Type>) {
+        return std::uninitialized_copy(first, last, dest);
+    } else {
+        Type* current = dest;
+        try {
+            for (; first != last; ++first, ++current) {
+                std::allocator_traits<Allocator>::construct(alloc, current, *first);
+            }
+        } catch (...) {
+            DestroyN(alloc, dest, current - dest);
+            throw;
+        }
+        return current;
+    }
+}
+
+// Переносит count элементов в неинициализированную память dest, исходные элементы не разрушаются.
+// Копирует, если перемещение может выбросить исключение, а копирование доступно
+template <typename Allocator, typename Type>
+void UninitializedRelocateN(Allocator& alloc, Type* first, size_t count, Type* dest) {
+    if constexpr (std::is_nothrow_move_constructible_v<Type> || !std::is_copy_constructible_v<Type>) {
+        UninitializedCopy(alloc, std::make_move_iterator(first), std::make_move_iterator(first + count), dest);
+    } else {
+        UninitializedCopy(alloc, first, first + count, dest);
+    }
+}
+
+// Для Prefetch заранее известного элемента в циклах со случайным доступом
+inline void PrefetchAddress(const void* address, PrefetchHint hint) noexcept {
+    switch (hint) {
+        case PrefetchHint::kRead:
+            __builtin_prefetch(address, 0, 3);
+            break;
+        case PrefetchHint::kWrite:
+            __builtin_prefetch(address, 1, 3);
+            break;
+        case PrefetchHint::kReadOnce:
+            __builtin_prefetch(address, 0, 0);
+            break;
+    }
+}
+
+}  // namespace detail
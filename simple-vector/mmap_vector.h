@@ -0,0 +1,438 @@
+#pragma once
+
+#include <cerrno>
+#include <cstdlib>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "compare_ops.h"
+#include "growth_policy.h"
+#include "memory_utils.h"
+#include "vector_ops.h"
+
+enum class MmapMode {
+    kReadWrite,  // файл создаётся при необходимости, изменения попадают в файл
+    kReadOnly,   // файл должен существовать; методы, меняющие размер, бросают std::logic_error
+};
+
+// Подсказки ядру о порядке доступа (madvise)
+enum class MmapAccess {
+    kNormal,
+    kSequential,  // агрессивное упреждающее чтение, прочитанные страницы освобождаются раньше
+    kRandom,      // без упреждающего чтения
+    kWillNeed,    // начать подкачку всего файла сейчас
+};
+
+// Владеет отображением файла в память (MAP_SHARED) под size элементов типа Type.
+// Изменение размера меняет длину файла (ftruncate) и переотображает его, на Linux через mremap
+// без копирования. Страницы общие с кэшем страниц, так что несколько процессов, открывших
+// один файл, не держат отдельных копий
+template <typename Type>
+class MmapArrayPtr {
+    static_assert(std::is_trivially_copyable_v<Type>, "a mapped file can hold only trivially copyable types");
+
+public:
+    MmapArrayPtr(const std::string& path, MmapMode mode)
+            : writable_(mode == MmapMode::kReadWrite)
+    {
+        fd_ = writable_ ? ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644)
+                        : ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd_ < 0) {
+            ThrowSystemError("open " + path);
+        }
+        struct stat info;
+        if (::fstat(fd_, &info) != 0) {
+            const int error = errno;
+            ::close(fd_);
+            throw std::system_error(error, std::generic_category(), "fstat " + path);
+        }
+        const size_t bytes = static_cast<size_t>(info.st_size);
+        if (bytes % sizeof(Type) != 0) {
+            ::close(fd_);
+            throw std::runtime_error("file size of " + path + " is not a multiple of the element size");
+        }
+        try {
+            Map(bytes / sizeof(Type));
+        } catch (...) {
+            ::close(fd_);
+            throw;
+        }
+    }
+
+    MmapArrayPtr(const MmapArrayPtr&) = delete;
+    MmapArrayPtr& operator=(const MmapArrayPtr&) = delete;
+
+    MmapArrayPtr(MmapArrayPtr&& other) noexcept
+            : fd_(std::exchange(other.fd_, -1))
+            , writable_(other.writable_)
+            , raw_ptr_(std::exchange(other.raw_ptr_, nullptr))
+            , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    MmapArrayPtr& operator=(MmapArrayPtr&& rhs) noexcept {
+        if (this != &rhs) {
+            MmapArrayPtr tmp(std::move(rhs));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~MmapArrayPtr() {
+        Unmap();
+        if (fd_ >= 0) {
+            ::close(fd_);
+        }
+    }
+
+    Type* Get() const noexcept {
+        return raw_ptr_;
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool IsWritable() const noexcept {
+        return writable_;
+    }
+
+    // Делает длину файла и отображения равной new_size элементам. Новые байты файла нулевые
+    void Reallocate(size_t new_size) {
+        if (new_size == size_) {
+            return;
+        }
+        if (!writable_) {
+            throw std::logic_error("file is mapped read-only");
+        }
+        if (new_size > size_) {
+            // файл растёт до отображения: обращение за конец файла дало бы SIGBUS
+            Truncate(new_size);
+            Remap(new_size);
+        } else {
+            Remap(new_size);
+            Truncate(new_size);
+        }
+    }
+
+    void Advise(MmapAccess access) const {
+        if (raw_ptr_ == nullptr) {
+            return;
+        }
+        static constexpr int kAdvice[] = {MADV_NORMAL, MADV_SEQUENTIAL, MADV_RANDOM, MADV_WILLNEED};
+        if (::madvise(raw_ptr_, size_ * sizeof(Type), kAdvice[static_cast<int>(access)]) != 0) {
+            ThrowSystemError("madvise");
+        }
+    }
+
+    // Дожидается записи изменённых страниц на диск
+    void Sync() const {
+        if (raw_ptr_ != nullptr && ::msync(raw_ptr_, size_ * sizeof(Type), MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+    void swap(MmapArrayPtr& other) noexcept {
+        std::swap(fd_, other.fd_);
+        std::swap(writable_, other.writable_);
+        std::swap(raw_ptr_, other.raw_ptr_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    int fd_ = -1;
+    bool writable_ = false;
+    Type* raw_ptr_ = nullptr;
+    size_t size_ = 0;
+
+    [[noreturn]] static void ThrowSystemError(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    void Truncate(size_t size) {
+        if (::ftruncate(fd_, static_cast<off_t>(size * sizeof(Type))) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+    }
+
+    // Пустой файл не отображается: mmap нулевой длины недопустим
+    void Map(size_t size) {
+        if (size == 0) {
+            return;
+        }
+        const int protection = writable_ ? PROT_READ | PROT_WRITE : PROT_READ;
+        void* p = ::mmap(nullptr, size * sizeof(Type), protection, MAP_SHARED, fd_, 0);
+        if (p == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        raw_ptr_ = static_cast<Type*>(p);
+        size_ = size;
+    }
+
+    void Unmap() noexcept {
+        if (raw_ptr_ != nullptr) {
+            ::munmap(raw_ptr_, size_ * sizeof(Type));
+            raw_ptr_ = nullptr;
+            size_ = 0;
+        }
+    }
+
+    void Remap(size_t new_size) {
+        if (raw_ptr_ == nullptr || new_size == 0) {
+            Unmap();
+            Map(new_size);
+            return;
+        }
+#ifdef MREMAP_MAYMOVE
+        void* p = ::mremap(raw_ptr_, size_ * sizeof(Type), new_size * sizeof(Type), MREMAP_MAYMOVE);
+        if (p == MAP_FAILED) {
+            ThrowSystemError("mremap");
+        }
+        raw_ptr_ = static_cast<Type*>(p);
+        size_ = new_size;
+#else
+        // данные живут в файле, поэтому достаточно отобразить его заново
+        Unmap();
+        Map(new_size);
+#endif
+    }
+};
+
+// Вектор, элементы которого лежат в файле: открытие файла не читает и не копирует данные,
+// страницы подгружаются по обращению. Интерфейс - как у SimpleVector, итераторы - указатели.
+// Вместимость сверх размера тоже принадлежит файлу; при закрытии файл обрезается до GetSize()
+// элементов, так что следующее открытие видит ровно сохранённые элементы
+template <typename Type, typename GrowthPolicy = DefaultGrowthPolicy>
+class MmapSimpleVector {
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    explicit MmapSimpleVector(const std::string& path, MmapMode mode = MmapMode::kReadWrite)
+            : items_(path, mode)
+            , size_(items_.GetSize())
+    {
+    }
+
+    MmapSimpleVector(MmapSimpleVector&& other) noexcept
+            : items_(std::move(other.items_))
+            , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    MmapSimpleVector& operator=(MmapSimpleVector&& rhs) noexcept {
+        if (this != &rhs) {
+            MmapSimpleVector tmp(std::move(rhs));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~MmapSimpleVector() {
+        if (items_.IsWritable()) {
+            try {
+                items_.Reallocate(size_);
+            } catch (...) {
+                // файл остаётся длиннее размера; деструктор не может сообщить об ошибке
+            }
+        }
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return items_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    bool IsWritable() const noexcept {
+        return items_.IsWritable();
+    }
+
+    // В режиме kReadOnly память доступна только для чтения: запись через неконстантный доступ недопустима
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return items_.Get()[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return items_.Get()[index];
+    }
+
+    Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return items_.Get()[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return items_.Get()[index];
+    }
+
+    Iterator begin() noexcept {
+        return items_.Get();
+    }
+
+    Iterator end() noexcept {
+        return items_.Get() + size_;
+    }
+
+    ConstIterator begin() const noexcept {
+        return items_.Get();
+    }
+
+    ConstIterator end() const noexcept {
+        return items_.Get() + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    void Clear() {
+        CheckWritable();
+        size_ = 0;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > GetCapacity()) {
+            items_.Reallocate(new_capacity);
+        }
+    }
+
+    // Возвращает файлу неиспользуемую вместимость
+    void ShrinkToFit() {
+        items_.Reallocate(size_);
+    }
+
+    void Resize(size_t new_size) {
+        CheckWritable();
+        if (new_size > GetCapacity()) {
+            items_.Reallocate(new_size);
+        }
+        if (new_size > size_) {
+            // после PopBack в хвосте могут остаться старые байты
+            std::uninitialized_value_construct_n(items_.Get() + size_, new_size - size_);
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        // аргументы могут ссылаться на элементы, которые переедут при переотображении
+        Type value(std::forward<Args>(args)...);
+        Grow(size_ + 1);
+        Type* const slot = ::new (static_cast<void*>(items_.Get() + size_)) Type(value);
+        ++size_;
+        return *slot;
+    }
+
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        assert(pos >= begin() && pos <= end());
+        const size_t p = pos - begin();
+        Type copy = value;
+        Grow(size_ + 1);
+        detail::InsertInPlace(alloc_, items_.Get(), size_, p, std::move(copy));
+        return begin() + p;
+    }
+
+    // Диапазон не должен указывать на элементы самого вектора
+    template <typename ForwardIt>
+    void Append(ForwardIt first, ForwardIt last) {
+        const size_t count = std::distance(first, last);
+        Grow(size_ + count);
+        detail::UninitializedCopy(alloc_, first, last, items_.Get() + size_);
+        size_ += count;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        assert(pos >= begin() && pos < end());
+        return Erase(pos, pos + 1);
+    }
+
+    Iterator Erase(ConstIterator first, ConstIterator last) {
+        assert(begin() <= first && first <= last && last <= end());
+        CheckWritable();
+        const size_t p = first - begin();
+        detail::EraseRange(alloc_, items_.Get(), size_, p, last - first);
+        return begin() + p;
+    }
+
+    void Advise(MmapAccess access) const {
+        items_.Advise(access);
+    }
+
+    void Sync() const {
+        items_.Sync();
+    }
+
+    void swap(MmapSimpleVector& other) noexcept {
+        items_.swap(other.items_);
+        std::swap(size_, other.size_);
+    }
+
+private:
+    MmapArrayPtr<Type> items_;
+    size_t size_ = 0;
+    // нужен только общим операциям из vector_ops.h
+    [[no_unique_address]] std::allocator<Type> alloc_;
+
+    void CheckWritable() const {
+        if (!items_.IsWritable()) {
+            throw std::logic_error("file is mapped read-only");
+        }
+    }
+
+    void Grow(size_t required) {
+        CheckWritable();
+        if (required > GetCapacity()) {
+            items_.Reallocate(GrowthPolicy::NextCapacity(GetCapacity(), required, sizeof(Type)));
+        }
+    }
+};
+
+template <typename Type, typename GrowthPolicy>
+bool operator==(const MmapSimpleVector<Type, GrowthPolicy>& lhs, const MmapSimpleVector<Type, GrowthPolicy>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && detail::EqualRanges(lhs.begin(), rhs.begin(), lhs.GetSize());
+}
+
+template <typename Type, typename GrowthPolicy>
+bool operator!=(const MmapSimpleVector<Type, GrowthPolicy>& lhs, const MmapSimpleVector<Type, GrowthPolicy>& rhs) {
+    return !(lhs == rhs);
+}
@@ -0,0 +1,521 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <numeric>
+#include <optional>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "simple_span.h"
+#include "simple_vector.h"
+
+// Пул потоков с очередью задач у каждого потока: поток берёт задачи из своей очереди с конца,
+// а опустевший поток крадёт их из начала чужих очередей
+class ThreadPool {
+public:
+    explicit ThreadPool(size_t thread_count = std::max<size_t>(1, std::thread::hardware_concurrency())) {
+        // последняя очередь принадлежит потокам, не входящим в пул
+        for (size_t i = 0; i <= thread_count; ++i) {
+            queues_.push_back(std::make_unique<Queue>());
+        }
+        workers_.reserve(thread_count);
+        for (size_t i = 0; i < thread_count; ++i) {
+            workers_.emplace_back([this, i] {
+                WorkerLoop(i);
+            });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    ~ThreadPool() {
+        {
+            std::lock_guard lock(mutex_);
+            stop_ = true;
+        }
+        wake_.notify_all();
+        for (auto& worker : workers_) {
+            worker.join();
+        }
+    }
+
+    size_t GetThreadCount() const noexcept {
+        return workers_.size();
+    }
+
+    // Выполняет body(i) для всех i из [0, count) и ждёт завершения. Вызывающий поток сам выполняет
+    // задачи, пока ждёт, поэтому вложенные вызовы из задач пула не блокируют его.
+    // Первое исключение из body пробрасывается после завершения остальных задач. Если задачу не удалось
+    // поставить в очередь, исключение пробрасывается после завершения уже поставленных
+    template <typename Body>
+    void ParallelFor(size_t count, const Body& body) {
+        if (count == 0) {
+            return;
+        }
+        Batch batch;
+        batch.remaining = count;
+
+        const size_t home = HomeQueue();
+        size_t queued = 0;
+        try {
+            for (; queued < count; ++queued) {
+                // задачи раскладываются по очередям сразу, чтобы потокам не приходилось красть с самого начала
+                Push((home + queued) % queues_.size(), [&batch, &body, i = queued] {
+                    std::exception_ptr error;
+                    try {
+                        body(i);
+                    } catch (...) {
+                        error = std::current_exception();
+                    }
+                    // уменьшение и уведомление под mutex: вызывающий поток не увидит ноль и не разрушит
+                    // batch, пока последняя задача не отпустит mutex
+                    std::lock_guard lock(batch.mutex);
+                    if (error && !batch.error) {
+                        batch.error = std::move(error);
+                    }
+                    if (--batch.remaining == 0) {
+                        batch.done.notify_all();
+                    }
+                });
+            }
+        } catch (...) {
+            // поставленные задачи ссылаются на batch и body: их нужно дождаться до выхода
+            {
+                std::lock_guard lock(batch.mutex);
+                batch.remaining -= count - queued;
+            }
+            Wait(batch, home);
+            throw;
+        }
+
+        Wait(batch, home);
+        if (batch.error) {
+            std::rethrow_exception(batch.error);
+        }
+    }
+
+    // Общий пул по числу аппаратных потоков, создаётся при первом обращении
+    static ThreadPool& Default() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+private:
+    using Task = std::function<void()>;
+
+    struct Queue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    struct Batch {
+        std::mutex mutex;
+        std::condition_variable done;
+        size_t remaining = 0;
+        std::exception_ptr error;
+
+        bool IsDone() {
+            std::lock_guard lock(mutex);
+            return remaining == 0;
+        }
+    };
+
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> workers_;
+    std::mutex mutex_;
+    std::condition_variable wake_;
+    std::atomic<size_t> pending_ = 0;
+    bool stop_ = false;
+
+    // Пул и номер потока, выполняющего WorkerLoop
+    static inline thread_local const ThreadPool* current_pool_ = nullptr;
+    static inline thread_local size_t current_index_ = 0;
+
+    size_t HomeQueue() const noexcept {
+        return current_pool_ == this ? current_index_ : queues_.size() - 1;
+    }
+
+    void Push(size_t index, Task task) {
+        {
+            // счётчик растёт под mutex_, иначе засыпающий поток может пропустить уведомление,
+            // и раньше самой задачи, чтобы не уйти в минус, когда её сразу заберут
+            std::lock_guard lock(mutex_);
+            pending_.fetch_add(1, std::memory_order_relaxed);
+        }
+        try {
+            std::lock_guard lock(queues_[index]->mutex);
+            queues_[index]->tasks.push_back(std::move(task));
+        } catch (...) {
+            pending_.fetch_sub(1, std::memory_order_relaxed);
+            throw;
+        }
+        wake_.notify_one();
+    }
+
+    // Выполняет задачи пула, пока не завершатся все задачи batch
+    void Wait(Batch& batch, size_t home) {
+        while (!batch.IsDone()) {
+            if (!TryRunOne(home)) {
+                // все оставшиеся задачи уже выполняются другими потоками
+                std::unique_lock lock(batch.mutex);
+                batch.done.wait(lock, [&batch] {
+                    return batch.remaining == 0;
+                });
+            }
+        }
+    }
+
+    bool TryPop(size_t index, bool steal, Task& task) {
+        Queue& queue = *queues_[index];
+        std::lock_guard lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            return false;
+        }
+        if (steal) {
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        } else {
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        pending_.fetch_sub(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    bool TryRunOne(size_t home) {
+        Task task;
+        bool found = TryPop(home, false, task);
+        for (size_t i = 1; !found && i < queues_.size(); ++i) {
+            found = TryPop((home + i) % queues_.size(), true, task);
+        }
+        if (found) {
+            task();
+        }
+        return found;
+    }
+
+    void WorkerLoop(size_t index) {
+        current_pool_ = this;
+        current_index_ = index;
+        while (true) {
+            if (TryRunOne(index)) {
+                continue;
+            }
+            std::unique_lock lock(mutex_);
+            wake_.wait(lock, [this] {
+                return stop_ || pending_.load(std::memory_order_relaxed) != 0;
+            });
+            if (stop_) {
+                return;
+            }
+        }
+    }
+};
+
+// Настройки параллельных алгоритмов
+struct ParallelOptions {
+    // диапазоны короче этого обрабатываются в вызывающем потоке
+    size_t sequential_threshold = 1 << 15;
+    // nullptr - ThreadPool::Default()
+    ThreadPool* pool = nullptr;
+};
+
+namespace detail {
+
+inline constexpr size_t kCacheLineSize = 64;
+inline constexpr size_t kPageSize = 4096;
+
+inline ThreadPool& GetPool(const ParallelOptions& options) {
+    return options.pool != nullptr ? *options.pool : ThreadPool::Default();
+}
+
+// Делит [first, first + size) на куски по несколько на поток (чтобы было что красть).
+// Для непрерывной памяти границы кусков, кроме крайних, попадают на начало блока alignment байт
+// (по умолчанию кэш-строки), так что два потока не пишут в одну строку. Возвращает индексы границ, от 0 до size
+template <typename RandomIt>
+std::vector<size_t> SplitIntoChunks(RandomIt first, size_t size, size_t thread_count,
+                                    size_t alignment = kCacheLineSize) {
+    using Value = typename std::iterator_traits<RandomIt>::value_type;
+    const size_t chunk_count = std::max<size_t>(1, std::min(thread_count * 4, size));
+    size_t chunk = (size + chunk_count - 1) / chunk_count;
+
+    // сдвиг первой выровненной границы и шаг выравнивания в элементах
+    size_t offset = 0;
+    if constexpr (std::contiguous_iterator<RandomIt>) {
+        const auto address = reinterpret_cast<std::uintptr_t>(std::to_address(first));
+        if (alignment % sizeof(Value) == 0 && address % sizeof(Value) == 0) {
+            const size_t step = alignment / sizeof(Value);
+            offset = (alignment - address % alignment) % alignment / sizeof(Value);
+            chunk = (chunk + step - 1) / step * step;
+        }
+    }
+
+    std::vector<size_t> bounds{0};
+    for (size_t bound = offset + chunk; bound < size; bound += chunk) {
+        bounds.push_back(bound);
+    }
+    bounds.push_back(size);
+    return bounds;
+}
+
+template <typename RandomIt, typename ChunkFunc>
+void ForEachChunk(RandomIt first, RandomIt last, const ParallelOptions& options, const ChunkFunc& func) {
+    const size_t size = last - first;
+    ThreadPool& pool = GetPool(options);
+    const std::vector<size_t> bounds = SplitIntoChunks(first, size, pool.GetThreadCount());
+    pool.ParallelFor(bounds.size() - 1, [&](size_t i) {
+        func(i, bounds[i], bounds[i + 1]);
+    });
+}
+
+// Конструирует элементы неинициализированного блока [data, data + size) по кускам на пуле:
+// init(chunk_data, begin, count) создаёт элементы [begin, begin + count) и при исключении сама
+// их разрушает. Каждую страницу первым трогает поток, который её заполняет, поэтому при первом
+// касании (first touch) страницы распределяются по NUMA-узлам потоков пула, а не достаются одному.
+// Аллокаторы со своим construct не обязаны быть потокобезопасными и заполняются последовательно
+template <typename Allocator, typename Type, typename ChunkInit>
+void ParallelUninitialized(Allocator& alloc, Type* data, size_t size, const ParallelOptions& options,
+                           const ChunkInit& init) {
+    if (size < options.sequential_threshold || !kDefaultConstruct<Allocator, Type>) {
+        init(data, 0, size);
+        return;
+    }
+    ThreadPool& pool = GetPool(options);
+    const std::vector<size_t> bounds = SplitIntoChunks(data, size, pool.GetThreadCount(), kPageSize);
+    const size_t chunk_count = bounds.size() - 1;
+    const std::unique_ptr<bool[]> done(new bool[chunk_count]());
+    try {
+        pool.ParallelFor(chunk_count, [&](size_t i) {
+            init(data + bounds[i], bounds[i], bounds[i + 1] - bounds[i]);
+            done[i] = true;
+        });
+    } catch (...) {
+        // ParallelFor дожидается всех кусков, так что флаги уже окончательные
+        for (size_t i = 0; i < chunk_count; ++i) {
+            if (done[i]) {
+                DestroyN(alloc, data + bounds[i], bounds[i + 1] - bounds[i]);
+            }
+        }
+        throw;
+    }
+}
+
+}  // namespace detail
+
+template <typename RandomIt, typename Func>
+void ParallelForEach(RandomIt first, RandomIt last, Func func, const ParallelOptions& options = {}) {
+    if (static_cast<size_t>(last - first) < options.sequential_threshold) {
+        std::for_each(first, last, func);
+        return;
+    }
+    detail::ForEachChunk(first, last, options, [&](size_t, size_t begin, size_t end) {
+        std::for_each(first + begin, first + end, func);
+    });
+}
+
+// Выходной диапазон не должен перекрываться с входным, кроме случая d_first == first
+template <typename RandomIt, typename OutRandomIt, typename UnaryOp>
+OutRandomIt ParallelTransform(RandomIt first, RandomIt last, OutRandomIt d_first, UnaryOp op,
+                              const ParallelOptions& options = {}) {
+    if (static_cast<size_t>(last - first) < options.sequential_threshold) {
+        return std::transform(first, last, d_first, op);
+    }
+    detail::ForEachChunk(first, last, options, [&](size_t, size_t begin, size_t end) {
+        std::transform(first + begin, first + end, d_first + begin, op);
+    });
+    return d_first + (last - first);
+}
+
+// op должна быть ассоциативной: куски сворачиваются независимо, а их результаты - по порядку
+template <typename RandomIt, typename T, typename BinaryOp = std::plus<>>
+T ParallelReduce(RandomIt first, RandomIt last, T init, BinaryOp op = {}, const ParallelOptions& options = {}) {
+    // пустой диапазон делится на один пустой кусок, у которого нет первого элемента
+    if (first == last || static_cast<size_t>(last - first) < options.sequential_threshold) {
+        return std::accumulate(first, last, std::move(init), op);
+    }
+    using Value = typename std::iterator_traits<RandomIt>::value_type;
+    using Partial = std::remove_cvref_t<std::invoke_result_t<BinaryOp&, Value, Value>>;
+    // у каждого куска свой результат, выровненный на кэш-строку, чтобы потоки не делили строки
+    struct alignas(detail::kCacheLineSize) Slot {
+        std::optional<Partial> value;
+    };
+    ThreadPool& pool = detail::GetPool(options);
+    const std::vector<size_t> bounds = detail::SplitIntoChunks(first, last - first, pool.GetThreadCount());
+    std::vector<Slot> partials(bounds.size() - 1);
+    pool.ParallelFor(partials.size(), [&](size_t i) {
+        if (bounds[i] == bounds[i + 1]) {
+            return;
+        }
+        Partial acc = first[bounds[i]];
+        for (size_t j = bounds[i] + 1; j < bounds[i + 1]; ++j) {
+            acc = op(std::move(acc), first[j]);
+        }
+        partials[i].value.emplace(std::move(acc));
+    });
+    for (auto& slot : partials) {
+        if (slot.value) {
+            init = op(std::move(init), std::move(*slot.value));
+        }
+    }
+    return init;
+}
+
+// Куски сортируются параллельно, затем попарно сливаются, пока не останется один
+template <typename RandomIt, typename Compare = std::less<>>
+void ParallelSort(RandomIt first, RandomIt last, Compare comp = {}, const ParallelOptions& options = {}) {
+    const size_t size = last - first;
+    if (size < options.sequential_threshold) {
+        std::sort(first, last, comp);
+        return;
+    }
+    ThreadPool& pool = detail::GetPool(options);
+    const std::vector<size_t> bounds = detail::SplitIntoChunks(first, size, pool.GetThreadCount());
+    const size_t chunk_count = bounds.size() - 1;
+    pool.ParallelFor(chunk_count, [&](size_t i) {
+        std::sort(first + bounds[i], first + bounds[i + 1], comp);
+    });
+    for (size_t width = 1; width < chunk_count; width *= 2) {
+        const size_t pairs = (chunk_count + 2 * width - 1) / (2 * width);
+        pool.ParallelFor(pairs, [&](size_t pair) {
+            const size_t left = pair * 2 * width;
+            const size_t mid = left + width;
+            if (mid < chunk_count) {
+                const size_t right = std::min(mid + width, chunk_count);
+                std::inplace_merge(first + bounds[left], first + bounds[mid], first + bounds[right], comp);
+            }
+        });
+    }
+}
+
+template <typename Type, typename Allocator, typename GrowthPolicy, typename Func>
+void ParallelForEach(SimpleVector<Type, Allocator, GrowthPolicy>& vector, Func func,
+                     const ParallelOptions& options = {}) {
+    ParallelForEach(vector.Data(), vector.Data() + vector.GetSize(), std::move(func), options);
+}
+
+template <typename Type, typename Allocator, typename GrowthPolicy, typename OutRandomIt, typename UnaryOp>
+OutRandomIt ParallelTransform(const SimpleVector<Type, Allocator, GrowthPolicy>& vector, OutRandomIt d_first,
+                              UnaryOp op, const ParallelOptions& options = {}) {
+    return ParallelTransform(vector.Data(), vector.Data() + vector.GetSize(), d_first, std::move(op), options);
+}
+
+template <typename Type, typename Allocator, typename GrowthPolicy, typename T, typename BinaryOp = std::plus<>>
+T ParallelReduce(const SimpleVector<Type, Allocator, GrowthPolicy>& vector, T init, BinaryOp op = {},
+                 const ParallelOptions& options = {}) {
+    return ParallelReduce(vector.Data(), vector.Data() + vector.GetSize(), std::move(init), std::move(op), options);
+}
+
+template <typename Type, typename Allocator, typename GrowthPolicy, typename Compare = std::less<>>
+void ParallelSort(SimpleVector<Type, Allocator, GrowthPolicy>& vector, Compare comp = {},
+                  const ParallelOptions& options = {}) {
+    ParallelSort(vector.Data(), vector.Data() + vector.GetSize(), std::move(comp), options);
+}
+
+template <typename Type, typename Func>
+void ParallelForEach(SimpleSpan<Type> span, Func func, const ParallelOptions& options = {}) {
+    ParallelForEach(span.begin(), span.end(), std::move(func), options);
+}
+
+template <typename Type, typename OutRandomIt, typename UnaryOp>
+OutRandomIt ParallelTransform(SimpleSpan<Type> span, OutRandomIt d_first, UnaryOp op,
+                              const ParallelOptions& options = {}) {
+    return ParallelTransform(span.begin(), span.end(), d_first, std::move(op), options);
+}
+
+template <typename Type, typename T, typename BinaryOp = std::plus<>>
+T ParallelReduce(SimpleSpan<Type> span, T init, BinaryOp op = {}, const ParallelOptions& options = {}) {
+    return ParallelReduce(span.begin(), span.end(), std::move(init), std::move(op), options);
+}
+
+template <typename Type, typename Compare = std::less<>>
+void ParallelSort(SimpleSpan<Type> span, Compare comp = {}, const ParallelOptions& options = {}) {
+    ParallelSort(span.begin(), span.end(), std::move(comp), options);
+}
+
+namespace detail {
+
+template <typename Vector, typename Type, typename Allocator>
+Vector ParallelCopyRange(const Type* source, size_t size, const ParallelOptions& options, Allocator alloc) {
+    return Vector::FromUninitialized(size, [&](Type* data, size_t count) {
+        ParallelUninitialized(alloc, data, count, options, [&](Type* chunk, size_t begin, size_t n) {
+            UninitializedCopy(alloc, source + begin, source + begin + n, chunk);
+        });
+    }, alloc);
+}
+
+}  // namespace detail
+
+// Аналог SimpleVector(size): элементы создаются параллельно
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DefaultGrowthPolicy>
+SimpleVector<Type, Allocator, GrowthPolicy> ParallelMakeVector(size_t size, const ParallelOptions& options = {},
+                                                               const Allocator& alloc = Allocator()) {
+    using Vector = SimpleVector<Type, Allocator, GrowthPolicy>;
+    Allocator construct_alloc = alloc;
+    return Vector::FromUninitialized(size, [&](Type* data, size_t count) {
+        detail::ParallelUninitialized(construct_alloc, data, count, options, [&](Type* chunk, size_t, size_t n) {
+            detail::UninitializedValueConstructN(construct_alloc, chunk, n);
+        });
+    }, alloc);
+}
+
+// Аналог SimpleVector(size, value): копии value создаются параллельно
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DefaultGrowthPolicy>
+SimpleVector<Type, Allocator, GrowthPolicy> ParallelMakeVector(size_t size, const Type& value,
+                                                               const ParallelOptions& options = {},
+                                                               const Allocator& alloc = Allocator()) {
+    using Vector = SimpleVector<Type, Allocator, GrowthPolicy>;
+    Allocator construct_alloc = alloc;
+    return Vector::FromUninitialized(size, [&](Type* data, size_t count) {
+        detail::ParallelUninitialized(construct_alloc, data, count, options, [&](Type* chunk, size_t, size_t n) {
+            detail::UninitializedFillN(construct_alloc, chunk, n, value);
+        });
+    }, alloc);
+}
+
+// Аналог копирующего конструктора: элементы копируются параллельно
+template <typename Type, typename Allocator, typename GrowthPolicy>
+SimpleVector<Type, Allocator, GrowthPolicy> ParallelCopy(const SimpleVector<Type, Allocator, GrowthPolicy>& other,
+                                                         const ParallelOptions& options = {}) {
+    return detail::ParallelCopyRange<SimpleVector<Type, Allocator, GrowthPolicy>>(
+            other.Data(), other.GetSize(), options,
+            std::allocator_traits<Allocator>::select_on_container_copy_construction(other.GetAllocator()));
+}
+
+// Копирует элементы вида в новый SimpleVector параллельно
+template <typename Type, typename Allocator = std::allocator<std::remove_const_t<Type>>>
+SimpleVector<std::remove_const_t<Type>, Allocator> ParallelCopy(SimpleSpan<Type> span, const ParallelOptions& options = {},
+                                                                const Allocator& alloc = Allocator()) {
+    using Value = std::remove_const_t<Type>;
+    return detail::ParallelCopyRange<SimpleVector<Value, Allocator>>(static_cast<const Value*>(span.Get()),
+                                                                     span.GetSize(), options, alloc);
+}
+
+// Присваивает value всем элементам параллельно
+template <typename Type, typename Allocator, typename GrowthPolicy>
+void ParallelFill(SimpleVector<Type, Allocator, GrowthPolicy>& vector, const Type& value,
+                  const ParallelOptions& options = {}) {
+    ParallelForEach(vector, [&value](Type& item) {
+        item = value;
+    }, options);
+}
+
+template <typename Type>
+void ParallelFill(SimpleSpan<Type> span, const typename SimpleSpan<Type>::ValueType& value,
+                  const ParallelOptions& options = {}) {
+    ParallelForEach(span, [&value](Type& item) {
+        item = value;
+    }, options);
+}
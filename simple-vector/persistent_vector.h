@@ -0,0 +1,1185 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <new>
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+
+#include "simple_vector.h"
+
+// Неизменяемый вектор со структурным разделением: RRB-дерево (relaxed radix balanced) с ветвлением 32
+// и отдельным хвостом из последних элементов. Set, PushBack, PopBack, Concat и Slice возвращают новый вектор
+// за O(log32 n), который делит с исходным все узлы, кроме изменённого пути.
+// Узлы считают ссылки атомарно, поэтому версии можно свободно передавать между потоками.
+// Узел, на который ссылается только один вектор, изменяется на месте: так работают TransientVector
+// и перегрузки для rvalue (std::move(v).PushBack(x))
+namespace detail {
+
+inline constexpr size_t kPersistentBits = 5;
+inline constexpr size_t kPersistentWidth = size_t(1) << kPersistentBits;
+// Наибольший уровень корня, при котором kPersistentWidth << shift ещё помещается в size_t.
+// Сбалансированное дерево такой высоты больше любой адресуемой памяти
+inline constexpr size_t kPersistentMaxShift =
+        (sizeof(size_t) * 8 - kPersistentBits - 1) / kPersistentBits * kPersistentBits;
+
+template <typename Type>
+class PersistentTree {
+public:
+    struct Node {
+        std::atomic<size_t> refs = 1;
+        uint32_t count = 0;
+        const bool is_leaf;
+
+        explicit Node(bool leaf) noexcept
+                : is_leaf(leaf)
+        {
+        }
+    };
+
+    struct Leaf : Node {
+        alignas(Type) unsigned char storage[sizeof(Type) * kPersistentWidth];
+
+        Leaf() noexcept
+                : Node(true)
+        {
+        }
+
+        ~Leaf() {
+            std::destroy_n(Data(), this->count);
+        }
+
+        Type* Data() noexcept {
+            return std::launder(reinterpret_cast<Type*>(storage));
+        }
+
+        const Type* Data() const noexcept {
+            return std::launder(reinterpret_cast<const Type*>(storage));
+        }
+    };
+
+    struct Branch : Node {
+        Node* children[kPersistentWidth] = {};
+        // Накопленные размеры детей; nullptr, если все дети, кроме последнего, заполнены полностью
+        // и ребёнка можно найти по битам индекса
+        std::unique_ptr<size_t[]> sizes;
+
+        Branch() noexcept
+                : Node(false)
+        {
+        }
+
+        ~Branch() {
+            for (size_t i = 0; i < this->count; ++i) {
+                Release(children[i]);
+            }
+        }
+
+        // Индекс ребёнка, содержащего элемент index. Ребёнок вмещает не больше 1 << shift элементов,
+        // поэтому искомый не левее index >> shift
+        size_t ChildIndex(size_t index, size_t shift) const noexcept {
+            size_t child = index >> shift;
+            if (sizes != nullptr) {
+                while (sizes[child] <= index) {
+                    ++child;
+                }
+            }
+            return child;
+        }
+
+        size_t SizeBefore(size_t child, size_t shift) const noexcept {
+            if (child == 0) {
+                return 0;
+            }
+            return sizes != nullptr ? sizes[child - 1] : child << shift;
+        }
+    };
+
+    PersistentTree() noexcept = default;
+
+    PersistentTree(const PersistentTree& other) noexcept
+            : root_(other.root_)
+            , tail_(other.tail_)
+            , size_(other.size_)
+            , shift_(other.shift_)
+    {
+        Retain(root_);
+        Retain(tail_);
+    }
+
+    PersistentTree& operator=(const PersistentTree& rhs) noexcept {
+        PersistentTree tmp(rhs);
+        swap(tmp);
+        return *this;
+    }
+
+    PersistentTree(PersistentTree&& other) noexcept {
+        swap(other);
+    }
+
+    PersistentTree& operator=(PersistentTree&& rhs) noexcept {
+        PersistentTree tmp(std::move(rhs));
+        swap(tmp);
+        return *this;
+    }
+
+    ~PersistentTree() {
+        Release(root_);
+        Release(tail_);
+    }
+
+    void swap(PersistentTree& other) noexcept {
+        std::swap(root_, other.root_);
+        std::swap(tail_, other.tail_);
+        std::swap(size_, other.size_);
+        std::swap(shift_, other.shift_);
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool SharesWith(const PersistentTree& other) const noexcept {
+        return root_ == other.root_ && tail_ == other.tail_;
+    }
+
+    // Лист, содержащий index, и индекс его первого элемента
+    const Leaf* LeafFor(size_t index, size_t& leaf_begin) const noexcept {
+        assert(index < size_);
+        const size_t tail_offset = TailOffset();
+        if (index >= tail_offset) {
+            leaf_begin = tail_offset;
+            return tail_;
+        }
+        leaf_begin = 0;
+        const Node* node = root_;
+        for (size_t shift = shift_; shift > 0; shift -= kPersistentBits) {
+            const Branch* branch = static_cast<const Branch*>(node);
+            const size_t child = branch->ChildIndex(index, shift);
+            const size_t before = branch->SizeBefore(child, shift);
+            index -= before;
+            leaf_begin += before;
+            node = branch->children[child];
+        }
+        return static_cast<const Leaf*>(node);
+    }
+
+    const Type& Get(size_t index) const noexcept {
+        size_t leaf_begin = 0;
+        return LeafFor(index, leaf_begin)->Data()[index - leaf_begin];
+    }
+
+    // Вызывает func(data, count) для каждого листа по порядку
+    template <typename Func>
+    void ForEachLeaf(Func&& func) const {
+        if (root_ != nullptr) {
+            VisitLeaves(root_, shift_, func);
+        }
+        if (tail_ != nullptr) {
+            func(static_cast<const Type*>(tail_->Data()), static_cast<size_t>(tail_->count));
+        }
+    }
+
+    // Значение принимается по значению: ссылка на элемент этого же дерева могла бы пережить
+    // общий узел, который заменяется копией
+    void Set(size_t index, Type value) {
+        assert(index < size_);
+        const size_t tail_offset = TailOffset();
+        if (index >= tail_offset) {
+            Editable(tail_)->Data()[index - tail_offset] = std::move(value);
+            return;
+        }
+        Node* node = Editable(root_);
+        for (size_t shift = shift_; shift > 0; shift -= kPersistentBits) {
+            Branch* branch = static_cast<Branch*>(node);
+            const size_t child = branch->ChildIndex(index, shift);
+            index -= branch->SizeBefore(child, shift);
+            node = Editable(branch->children[child]);
+        }
+        static_cast<Leaf*>(node)->Data()[index] = std::move(value);
+    }
+
+    template <typename... Args>
+    void EmplaceBack(Args&&... args) {
+        if (tail_ != nullptr && tail_->count < kPersistentWidth) {
+            if (IsUnique(tail_)) {
+                ::new (static_cast<void*>(tail_->Data() + tail_->count)) Type(std::forward<Args>(args)...);
+                ++tail_->count;
+            } else {
+                // старый хвост отпускается после конструирования: аргументы могут ссылаться на его элементы
+                Leaf* const copy = CopyLeaf(tail_, 0, tail_->count);
+                try {
+                    ::new (static_cast<void*>(copy->Data() + copy->count)) Type(std::forward<Args>(args)...);
+                } catch (...) {
+                    Release(copy);
+                    throw;
+                }
+                ++copy->count;
+                Release(tail_);
+                tail_ = copy;
+            }
+        } else {
+            // полный хвост уходит в дерево, а новый элемент начинает следующий
+            Leaf* const fresh = new Leaf;
+            try {
+                ::new (static_cast<void*>(fresh->Data())) Type(std::forward<Args>(args)...);
+            } catch (...) {
+                delete fresh;
+                throw;
+            }
+            fresh->count = 1;
+            if (tail_ != nullptr) {
+                try {
+                    PushLeaf(tail_);
+                } catch (...) {
+                    Release(fresh);
+                    throw;
+                }
+                Release(tail_);
+            }
+            tail_ = fresh;
+        }
+        ++size_;
+    }
+
+    void PopBack() {
+        assert(size_ > 0);
+        if (tail_->count > 1) {
+            if (IsUnique(tail_)) {
+                --tail_->count;
+                std::destroy_at(tail_->Data() + tail_->count);
+            } else {
+                Leaf* const copy = CopyLeaf(tail_, 0, tail_->count - 1);
+                Release(tail_);
+                tail_ = copy;
+            }
+        } else {
+            // последний лист дерева становится хвостом
+            Leaf* const leaf = root_ != nullptr ? PopLeaf() : nullptr;
+            Release(tail_);
+            tail_ = leaf;
+        }
+        --size_;
+    }
+
+    // Оставляет первые count элементов
+    void Take(size_t count) {
+        if (count >= size_) {
+            return;
+        }
+        const size_t tail_offset = TailOffset();
+        if (count > tail_offset) {
+            // дерево не меняется, укорачивается только хвост
+            const size_t tail_count = count - tail_offset;
+            if (IsUnique(tail_)) {
+                std::destroy(tail_->Data() + tail_count, tail_->Data() + tail_->count);
+                tail_->count = static_cast<uint32_t>(tail_count);
+            } else {
+                Leaf* const copy = CopyLeaf(tail_, 0, tail_count);
+                Release(tail_);
+                tail_ = copy;
+            }
+            size_ = count;
+            return;
+        }
+        PersistentTree result;
+        if (count != 0) {
+            result.root_ = TakeFrom(root_, shift_, count);
+            result.shift_ = shift_;
+            result.size_ = count;
+            result.tail_ = result.PopLeaf();
+        }
+        swap(result);
+    }
+
+    // Отбрасывает первые count элементов
+    void Drop(size_t count) {
+        if (count == 0) {
+            return;
+        }
+        PersistentTree result;
+        if (count < size_) {
+            const size_t tail_offset = TailOffset();
+            if (count >= tail_offset) {
+                result.tail_ = CopyLeaf(tail_, count - tail_offset, tail_->count);
+            } else {
+                result.root_ = DropFrom(root_, shift_, count);
+                result.shift_ = shift_;
+                result.tail_ = tail_;
+                Retain(tail_);
+                result.Normalize();
+            }
+            result.size_ = size_ - count;
+        }
+        swap(result);
+    }
+
+    // Дописывает other в конец: правый край этого дерева и левый край other сливаются,
+    // а узлы на стыке на каждом уровне перепаковываются, чтобы дерево оставалось сбалансированным
+    void Append(const PersistentTree& other) {
+        if (other.size_ == 0) {
+            return;
+        }
+        if (size_ == 0) {
+            *this = other;
+            return;
+        }
+        PersistentTree result(*this);
+        if (other.root_ == nullptr) {
+            for (size_t i = 0; i < other.tail_->count; ++i) {
+                result.EmplaceBack(other.tail_->Data()[i]);
+            }
+            swap(result);
+            return;
+        }
+        result.PushLeaf(result.tail_);
+        Release(result.tail_);
+        result.tail_ = nullptr;
+
+        NodeList merged;
+        ConcatNodes(result.root_, result.shift_, other.root_, other.shift_, merged);
+        size_t shift = std::max(result.shift_, other.shift_);
+        Node* root = nullptr;
+        if (merged.count == 1) {
+            root = std::exchange(merged.nodes[0], nullptr);
+            merged.count = 0;
+        } else {
+            shift += kPersistentBits;
+            if (shift > kPersistentMaxShift) {
+                throw std::length_error("PersistentVector is too deep");
+            }
+            root = MakeBranch(merged, 0, merged.count, shift);
+        }
+        Release(result.root_);
+        result.root_ = root;
+        result.shift_ = shift;
+        result.tail_ = other.tail_;
+        Retain(other.tail_);
+        result.size_ += other.size_;
+        result.Normalize();
+        swap(result);
+    }
+
+private:
+    // Узлы, которыми владеет список: до 31 ребёнка слева, два на стыке и до 31 справа
+    struct NodeList {
+        Node* nodes[2 * kPersistentWidth] = {};
+        size_t count = 0;
+
+        NodeList() noexcept = default;
+        NodeList(const NodeList&) = delete;
+        NodeList& operator=(const NodeList&) = delete;
+
+        ~NodeList() {
+            for (size_t i = 0; i < count; ++i) {
+                Release(nodes[i]);
+            }
+        }
+
+        void Push(Node* node) noexcept {
+            nodes[count++] = node;
+        }
+
+        void PushShared(Node* node) noexcept {
+            Retain(node);
+            Push(node);
+        }
+    };
+
+    Node* root_ = nullptr;
+    Leaf* tail_ = nullptr;
+    size_t size_ = 0;
+    size_t shift_ = kPersistentBits;
+
+    size_t TailOffset() const noexcept {
+        return size_ - (tail_ != nullptr ? tail_->count : 0);
+    }
+
+    static void Retain(const Node* node) noexcept {
+        if (node != nullptr) {
+            const_cast<Node*>(node)->refs.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    static void Release(Node* node) noexcept {
+        if (node != nullptr && node->refs.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            if (node->is_leaf) {
+                delete static_cast<Leaf*>(node);
+            } else {
+                delete static_cast<Branch*>(node);
+            }
+        }
+    }
+
+    static bool IsUnique(const Node* node) noexcept {
+        return node->refs.load(std::memory_order_acquire) == 1;
+    }
+
+    static Leaf* CopyLeaf(const Leaf* leaf, size_t first, size_t last) {
+        Leaf* const copy = new Leaf;
+        try {
+            std::uninitialized_copy(leaf->Data() + first, leaf->Data() + last, copy->Data());
+        } catch (...) {
+            delete copy;
+            throw;
+        }
+        copy->count = static_cast<uint32_t>(last - first);
+        return copy;
+    }
+
+    static Branch* CopyBranch(const Branch* branch) {
+        std::unique_ptr<Branch> copy(new Branch);
+        if (branch->sizes != nullptr) {
+            copy->sizes.reset(new size_t[kPersistentWidth]);
+            std::copy_n(branch->sizes.get(), branch->count, copy->sizes.get());
+        }
+        for (size_t i = 0; i < branch->count; ++i) {
+            Retain(branch->children[i]);
+            copy->children[i] = branch->children[i];
+        }
+        copy->count = branch->count;
+        return copy.release();
+    }
+
+    // Делает узел в slot собственным, заменяя общий узел копией
+    template <typename NodeType>
+    static NodeType* Editable(NodeType*& slot) {
+        if (!IsUnique(slot)) {
+            Node* copy = nullptr;
+            if (slot->is_leaf) {
+                const Leaf* leaf = static_cast<const Leaf*>(static_cast<const Node*>(slot));
+                copy = CopyLeaf(leaf, 0, leaf->count);
+            } else {
+                copy = CopyBranch(static_cast<const Branch*>(static_cast<const Node*>(slot)));
+            }
+            Release(slot);
+            slot = static_cast<NodeType*>(copy);
+        }
+        return slot;
+    }
+
+    static size_t SubtreeSize(const Node* node, size_t shift) noexcept {
+        size_t size = 0;
+        for (; shift > 0; shift -= kPersistentBits) {
+            const Branch* branch = static_cast<const Branch*>(node);
+            if (branch->sizes != nullptr) {
+                return size + branch->sizes[branch->count - 1];
+            }
+            size += static_cast<size_t>(branch->count - 1) << shift;
+            node = branch->children[branch->count - 1];
+        }
+        return size + node->count;
+    }
+
+    template <typename Func>
+    static void VisitLeaves(const Node* node, size_t shift, Func& func) {
+        if (shift == 0) {
+            const Leaf* leaf = static_cast<const Leaf*>(node);
+            func(leaf->Data(), static_cast<size_t>(leaf->count));
+            return;
+        }
+        const Branch* branch = static_cast<const Branch*>(node);
+        for (size_t i = 0; i < branch->count; ++i) {
+            VisitLeaves(branch->children[i], shift - kPersistentBits, func);
+        }
+    }
+
+    static void MakeRelaxed(Branch* branch, size_t shift) {
+        const size_t total = SubtreeSize(branch, shift);
+        branch->sizes.reset(new size_t[kPersistentWidth]);
+        for (size_t i = 0; i < branch->count; ++i) {
+            branch->sizes[i] = std::min((i + 1) << shift, total);
+        }
+    }
+
+    // Узел уровня shift, единственный путь которого ведёт к leaf
+    static Node* NewPath(size_t shift, Leaf* leaf) {
+        Retain(leaf);
+        Node* node = leaf;
+        for (size_t level = kPersistentBits; level <= shift; level += kPersistentBits) {
+            Branch* branch = nullptr;
+            try {
+                branch = new Branch;
+            } catch (...) {
+                Release(node);
+                throw;
+            }
+            branch->children[0] = node;
+            branch->count = 1;
+            node = branch;
+        }
+        return node;
+    }
+
+    // Уровень самой глубокой ветви на правом краю, в которой есть место; 0, если дерево заполнено
+    size_t InsertShift() const noexcept {
+        size_t result = 0;
+        const Node* node = root_;
+        for (size_t shift = shift_; shift > 0; shift -= kPersistentBits) {
+            const Branch* branch = static_cast<const Branch*>(node);
+            if (branch->count < kPersistentWidth) {
+                result = shift;
+            }
+            node = branch->children[branch->count - 1];
+        }
+        return result;
+    }
+
+    // Добавляет leaf последним листом дерева; дерево берёт свою ссылку на него
+    void PushLeaf(Leaf* leaf) {
+        if (root_ == nullptr) {
+            root_ = NewPath(kPersistentBits, leaf);
+            shift_ = kPersistentBits;
+            return;
+        }
+        const size_t insert_shift = InsertShift();
+        if (insert_shift != 0) {
+            AppendLeaf(Editable(root_), shift_, insert_shift, leaf);
+            return;
+        }
+        // места нет: дерево растёт на уровень
+        const size_t old_size = SubtreeSize(root_, shift_);
+        std::unique_ptr<Branch> root(new Branch);
+        if (old_size != kPersistentWidth << shift_) {
+            root->sizes.reset(new size_t[kPersistentWidth]);
+            root->sizes[0] = old_size;
+            root->sizes[1] = old_size + leaf->count;
+        }
+        root->children[1] = NewPath(shift_, leaf);
+        root->children[0] = root_;
+        root->count = 2;
+        root_ = root.release();
+        shift_ += kPersistentBits;
+    }
+
+    // Размеры на пути обновляются после рекурсии, поэтому исключение оставляет дерево целым
+    static void AppendLeaf(Node* node, size_t shift, size_t insert_shift, Leaf* leaf) {
+        Branch* branch = static_cast<Branch*>(node);
+        const size_t last = branch->count - 1;
+        if (shift != insert_shift) {
+            AppendLeaf(Editable(branch->children[last]), shift - kPersistentBits, insert_shift, leaf);
+            if (branch->sizes != nullptr) {
+                branch->sizes[last] += leaf->count;
+            }
+            return;
+        }
+        if (branch->sizes == nullptr &&
+            SubtreeSize(branch->children[last], shift - kPersistentBits) != size_t(1) << shift) {
+            MakeRelaxed(branch, shift);
+        }
+        branch->children[last + 1] = NewPath(shift - kPersistentBits, leaf);
+        if (branch->sizes != nullptr) {
+            branch->sizes[last + 1] = branch->sizes[last] + leaf->count;
+        }
+        ++branch->count;
+    }
+
+    // Забирает последний лист дерева вместе со ссылкой на него
+    Leaf* PopLeaf() {
+        Leaf* const leaf = PopLeafFrom(Editable(root_), shift_);
+        Normalize();
+        return leaf;
+    }
+
+    static Leaf* PopLeafFrom(Node* node, size_t shift) {
+        Branch* branch = static_cast<Branch*>(node);
+        const size_t last = branch->count - 1;
+        if (shift == kPersistentBits) {
+            --branch->count;
+            return static_cast<Leaf*>(std::exchange(branch->children[last], nullptr));
+        }
+        Node* const child = Editable(branch->children[last]);
+        Leaf* const leaf = PopLeafFrom(child, shift - kPersistentBits);
+        if (child->count == 0) {
+            Release(child);
+            branch->children[last] = nullptr;
+            --branch->count;
+        } else if (branch->sizes != nullptr) {
+            branch->sizes[last] -= leaf->count;
+        }
+        return leaf;
+    }
+
+    // Убирает пустой корень и корни с единственным ребёнком
+    void Normalize() noexcept {
+        if (root_ != nullptr && root_->count == 0) {
+            Release(std::exchange(root_, nullptr));
+        }
+        while (root_ != nullptr && shift_ > kPersistentBits && root_->count == 1) {
+            Node* const child = static_cast<Branch*>(root_)->children[0];
+            Retain(child);
+            Release(root_);
+            root_ = child;
+            shift_ -= kPersistentBits;
+        }
+        if (root_ == nullptr) {
+            shift_ = kPersistentBits;
+        }
+    }
+
+    // Новый узел с первыми count элементами поддерева, 0 < count <= размер поддерева
+    static Node* TakeFrom(const Node* node, size_t shift, size_t count) {
+        if (shift == 0) {
+            const Leaf* leaf = static_cast<const Leaf*>(node);
+            if (count == leaf->count) {
+                Retain(leaf);
+                return const_cast<Leaf*>(leaf);
+            }
+            return CopyLeaf(leaf, 0, count);
+        }
+        const Branch* branch = static_cast<const Branch*>(node);
+        const size_t child = branch->ChildIndex(count - 1, shift);
+        const size_t before = branch->SizeBefore(child, shift);
+        std::unique_ptr<Branch> result(new Branch);
+        if (branch->sizes != nullptr) {
+            result->sizes.reset(new size_t[kPersistentWidth]);
+            std::copy_n(branch->sizes.get(), child, result->sizes.get());
+            result->sizes[child] = count;
+        }
+        for (size_t i = 0; i < child; ++i) {
+            Retain(branch->children[i]);
+            result->children[i] = branch->children[i];
+            ++result->count;
+        }
+        result->children[child] = TakeFrom(branch->children[child], shift - kPersistentBits, count - before);
+        ++result->count;
+        return result.release();
+    }
+
+    // Новый узел без первых count элементов поддерева, count < размер поддерева.
+    // Первый ребёнок становится неполным, поэтому узел всегда хранит размеры
+    static Node* DropFrom(const Node* node, size_t shift, size_t count) {
+        if (count == 0) {
+            Retain(node);
+            return const_cast<Node*>(node);
+        }
+        if (shift == 0) {
+            const Leaf* leaf = static_cast<const Leaf*>(node);
+            return CopyLeaf(leaf, count, leaf->count);
+        }
+        const Branch* branch = static_cast<const Branch*>(node);
+        const size_t child = branch->ChildIndex(count, shift);
+        const size_t before = branch->SizeBefore(child, shift);
+        const size_t total = SubtreeSize(branch, shift);
+        std::unique_ptr<Branch> result(new Branch);
+        result->sizes.reset(new size_t[kPersistentWidth]);
+        result->children[0] = DropFrom(branch->children[child], shift - kPersistentBits, count - before);
+        result->count = 1;
+        for (size_t i = child; i < branch->count; ++i) {
+            if (i != child) {
+                Retain(branch->children[i]);
+                result->children[result->count++] = branch->children[i];
+            }
+            const size_t cumulative = branch->sizes != nullptr ? branch->sizes[i] : std::min((i + 1) << shift, total);
+            result->sizes[i - child] = cumulative - count;
+        }
+        return result.release();
+    }
+
+    // Ветвь уровня shift из узлов list.nodes[first, last); узлы переходят к ней.
+    // Размеры хранятся, только если кто-то из детей, кроме последнего, неполон
+    static Branch* MakeBranch(NodeList& list, size_t first, size_t last, size_t shift) {
+        std::unique_ptr<Branch> branch(new Branch);
+        bool strict = true;
+        for (size_t i = first; i + 1 < last; ++i) {
+            strict = strict && SubtreeSize(list.nodes[i], shift - kPersistentBits) == size_t(1) << shift;
+        }
+        if (!strict) {
+            branch->sizes.reset(new size_t[kPersistentWidth]);
+            size_t cumulative = 0;
+            for (size_t i = first; i < last; ++i) {
+                cumulative += SubtreeSize(list.nodes[i], shift - kPersistentBits);
+                branch->sizes[i - first] = cumulative;
+            }
+        }
+        for (size_t i = first; i < last; ++i) {
+            branch->children[i - first] = std::exchange(list.nodes[i], nullptr);
+        }
+        branch->count = static_cast<uint32_t>(last - first);
+        return branch.release();
+    }
+
+    // Сливает правый край left и левый край right в один или два узла уровня max(left_shift, right_shift).
+    // На каждом уровне дети стыка перепаковываются Rebalance, поэтому высота остаётся O(log32 n)
+    static void ConcatNodes(const Node* left, size_t left_shift, const Node* right, size_t right_shift,
+                            NodeList& out) {
+        if (left_shift == 0 && right_shift == 0) {
+            // листья стыка объединит Rebalance уровнем выше вместе с соседями
+            out.PushShared(const_cast<Node*>(left));
+            out.PushShared(const_cast<Node*>(right));
+            return;
+        }
+        const size_t shift = std::max(left_shift, right_shift);
+        NodeList children;
+        if (left_shift >= right_shift) {
+            const Branch* branch = static_cast<const Branch*>(left);
+            for (size_t i = 0; i + 1 < branch->count; ++i) {
+                children.PushShared(branch->children[i]);
+            }
+            left = branch->children[branch->count - 1];
+            left_shift -= kPersistentBits;
+        }
+        const Branch* right_branch = nullptr;
+        if (right_shift == shift) {
+            right_branch = static_cast<const Branch*>(right);
+            right = right_branch->children[0];
+            right_shift -= kPersistentBits;
+        }
+        ConcatNodes(left, left_shift, right, right_shift, children);
+        if (right_branch != nullptr) {
+            for (size_t i = 1; i < right_branch->count; ++i) {
+                children.PushShared(right_branch->children[i]);
+            }
+        }
+        Rebalance(children, shift - kPersistentBits);
+        // узлов на уровне больше 32: вторая ветвь получает остаток
+        const size_t split = std::min(children.count, kPersistentWidth);
+        out.Push(MakeBranch(children, 0, split, shift));
+        if (split < children.count) {
+            out.Push(MakeBranch(children, split, children.count, shift));
+        }
+    }
+
+    // Перепаковывает узлы уровня shift так, чтобы их было не больше ceil(слотов / 32) + kExtraSteps
+    // (инвариант шага поиска RRB): недозаполненные узлы по очереди сливаются со следующими.
+    // Узлы, которые план не меняет, переходят без копирования
+    static void Rebalance(NodeList& list, size_t shift) {
+        static constexpr size_t kExtraSteps = 2;
+        size_t sizes[2 * kPersistentWidth];
+        size_t total = 0;
+        for (size_t i = 0; i < list.count; ++i) {
+            sizes[i] = list.nodes[i]->count;
+            total += sizes[i];
+        }
+        const size_t optimal = (total + kPersistentWidth - 1) / kPersistentWidth;
+        size_t count = list.count;
+        if (count <= optimal + kExtraSteps) {
+            return;
+        }
+        for (size_t i = 0; count > optimal + kExtraSteps;) {
+            // полные узлы не трогаются
+            while (sizes[i] == kPersistentWidth) {
+                ++i;
+            }
+            // содержимое узла i растекается по следующим, пока не останется излишка
+            size_t remaining = sizes[i];
+            while (remaining > 0) {
+                assert(i + 1 < count);
+                const size_t merged = std::min(remaining + sizes[i + 1], kPersistentWidth);
+                remaining = remaining + sizes[i + 1] - merged;
+                sizes[i] = merged;
+                ++i;
+            }
+            std::copy(sizes + i + 1, sizes + count, sizes + i);
+            --count;
+            --i;
+        }
+
+        NodeList result;
+        size_t from = 0;
+        size_t offset = 0;
+        for (size_t i = 0; i < count; ++i) {
+            if (offset == 0 && list.nodes[from]->count == sizes[i]) {
+                result.Push(std::exchange(list.nodes[from++], nullptr));
+                continue;
+            }
+            if (shift == 0) {
+                Leaf* const leaf = new Leaf;
+                result.Push(leaf);
+                while (leaf->count < sizes[i]) {
+                    const Leaf* source = static_cast<const Leaf*>(list.nodes[from]);
+                    const size_t take = std::min<size_t>(sizes[i] - leaf->count, source->count - offset);
+                    std::uninitialized_copy_n(source->Data() + offset, take, leaf->Data() + leaf->count);
+                    leaf->count += static_cast<uint32_t>(take);
+                    offset += take;
+                    if (offset == source->count) {
+                        ++from;
+                        offset = 0;
+                    }
+                }
+            } else {
+                NodeList grandchildren;
+                while (grandchildren.count < sizes[i]) {
+                    const Branch* source = static_cast<const Branch*>(list.nodes[from]);
+                    grandchildren.PushShared(source->children[offset++]);
+                    if (offset == source->count) {
+                        ++from;
+                        offset = 0;
+                    }
+                }
+                result.Push(MakeBranch(grandchildren, 0, grandchildren.count, shift));
+            }
+        }
+        // старые узлы отпускаются, новые переходят в list
+        for (size_t i = 0; i < list.count; ++i) {
+            Release(std::exchange(list.nodes[i], nullptr));
+        }
+        std::copy_n(result.nodes, result.count, list.nodes);
+        list.count = std::exchange(result.count, 0);
+    }
+};
+
+}  // namespace detail
+
+template <typename Type>
+class TransientVector;
+
+template <typename Type>
+class PersistentVector {
+    using Tree = detail::PersistentTree<Type>;
+
+public:
+    class ConstIterator;
+    using Iterator = ConstIterator;
+
+    PersistentVector() noexcept = default;
+
+    PersistentVector(std::initializer_list<Type> init) {
+        for (const Type& item : init) {
+            tree_.EmplaceBack(item);
+        }
+    }
+
+    template <typename Allocator, typename GrowthPolicy>
+    explicit PersistentVector(const SimpleVector<Type, Allocator, GrowthPolicy>& items) {
+        for (const Type& item : items) {
+            tree_.EmplaceBack(item);
+        }
+    }
+
+    template <typename Allocator, typename GrowthPolicy>
+    explicit PersistentVector(SimpleVector<Type, Allocator, GrowthPolicy>&& items) {
+        for (Type& item : items) {
+            tree_.EmplaceBack(std::move(item));
+        }
+        items.Clear();
+    }
+
+    size_t GetSize() const noexcept {
+        return tree_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return tree_.Get(index);
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return tree_.Get(index);
+    }
+
+    ConstIterator begin() const noexcept {
+        return {&tree_, 0};
+    }
+
+    ConstIterator end() const noexcept {
+        return {&tree_, GetSize()};
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    PersistentVector Set(size_t index, Type value) const& {
+        return PersistentVector(*this).Set(index, std::move(value));
+    }
+
+    PersistentVector Set(size_t index, Type value) && {
+        if (index >= GetSize()) {
+            throw std::out_of_range("Method Set(index): index >= size");
+        }
+        tree_.Set(index, std::move(value));
+        return std::move(*this);
+    }
+
+    PersistentVector PushBack(const Type& item) const& {
+        return PersistentVector(*this).PushBack(item);
+    }
+
+    PersistentVector PushBack(Type&& item) const& {
+        return PersistentVector(*this).PushBack(std::move(item));
+    }
+
+    PersistentVector PushBack(const Type& item) && {
+        tree_.EmplaceBack(item);
+        return std::move(*this);
+    }
+
+    PersistentVector PushBack(Type&& item) && {
+        tree_.EmplaceBack(std::move(item));
+        return std::move(*this);
+    }
+
+    PersistentVector PopBack() const& {
+        return PersistentVector(*this).PopBack();
+    }
+
+    PersistentVector PopBack() && {
+        assert(!IsEmpty());
+        tree_.PopBack();
+        return std::move(*this);
+    }
+
+    // Элементы [first, last)
+    PersistentVector Slice(size_t first, size_t last) const {
+        if (first > last || last > GetSize()) {
+            throw std::out_of_range("Method Slice(first, last): invalid range");
+        }
+        PersistentVector result(*this);
+        result.tree_.Take(last);
+        result.tree_.Drop(first);
+        return result;
+    }
+
+    PersistentVector Concat(const PersistentVector& other) const {
+        PersistentVector result(*this);
+        result.tree_.Append(other.tree_);
+        return result;
+    }
+
+    // Изменяемая версия, которая делит узлы с этим вектором и копирует их только при первом изменении
+    TransientVector<Type> Transient() const& {
+        return TransientVector<Type>(*this);
+    }
+
+    TransientVector<Type> Transient() && {
+        return TransientVector<Type>(std::move(*this));
+    }
+
+    template <typename Allocator = std::allocator<Type>>
+    SimpleVector<Type, Allocator> ToSimpleVector(const Allocator& alloc = Allocator()) const {
+        return SimpleVector<Type, Allocator>::FromUninitialized(GetSize(), [this](Type* data, size_t) {
+            size_t copied = 0;
+            try {
+                tree_.ForEachLeaf([&](const Type* leaf, size_t count) {
+                    std::uninitialized_copy_n(leaf, count, data + copied);
+                    copied += count;
+                });
+            } catch (...) {
+                std::destroy_n(data, copied);
+                throw;
+            }
+        }, alloc);
+    }
+
+    // Векторы, полученные копированием без изменений, делят все узлы
+    bool SharesWith(const PersistentVector& other) const noexcept {
+        return tree_.SharesWith(other.tree_);
+    }
+
+    void swap(PersistentVector& other) noexcept {
+        tree_.swap(other.tree_);
+    }
+
+private:
+    friend class TransientVector<Type>;
+
+    Tree tree_;
+
+    explicit PersistentVector(Tree&& tree) noexcept
+            : tree_(std::move(tree))
+    {
+    }
+
+public:
+    // Итератор запоминает текущий лист, поэтому последовательный обход не спускается по дереву
+    // на каждом элементе
+    class ConstIterator {
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Type;
+        using difference_type = std::ptrdiff_t;
+        using reference = const Type&;
+        using pointer = const Type*;
+
+        ConstIterator() noexcept = default;
+
+        ConstIterator(const Tree* tree, size_t index) noexcept
+                : tree_(tree)
+                , index_(index)
+        {
+        }
+
+        reference operator*() const noexcept {
+            if (index_ < leaf_begin_ || index_ >= leaf_end_) {
+                size_t leaf_begin = 0;
+                const auto* leaf = tree_->LeafFor(index_, leaf_begin);
+                leaf_ = leaf->Data();
+                leaf_begin_ = leaf_begin;
+                leaf_end_ = leaf_begin + leaf->count;
+            }
+            return leaf_[index_ - leaf_begin_];
+        }
+
+        pointer operator->() const noexcept {
+            return &**this;
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return *(*this + n);
+        }
+
+        ConstIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        ConstIterator operator++(int) noexcept {
+            ConstIterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        ConstIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        ConstIterator operator--(int) noexcept {
+            ConstIterator old = *this;
+            --index_;
+            return old;
+        }
+
+        ConstIterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        ConstIterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        friend ConstIterator operator+(ConstIterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend ConstIterator operator+(difference_type n, ConstIterator it) noexcept {
+            return it += n;
+        }
+
+        friend ConstIterator operator-(ConstIterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend auto operator<=>(const ConstIterator& lhs, const ConstIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        const Tree* tree_ = nullptr;
+        size_t index_ = 0;
+        // лист, в котором лежал последний разыменованный элемент: [leaf_begin_, leaf_end_)
+        mutable const Type* leaf_ = nullptr;
+        mutable size_t leaf_begin_ = 0;
+        mutable size_t leaf_end_ = 0;
+    };
+};
+
+// Пакетно изменяемая версия PersistentVector. Узлы, которые она делит с другими векторами,
+// копируются при первом изменении, а собственные изменяются на месте, так что серия PushBack
+// стоит столько же, сколько в обычном векторе. Persistent() возвращает результат без копирования
+template <typename Type>
+class TransientVector {
+public:
+    TransientVector() noexcept = default;
+
+    explicit TransientVector(PersistentVector<Type> vector) noexcept
+            : tree_(std::move(vector.tree_))
+    {
+    }
+
+    TransientVector(const TransientVector&) = delete;
+    TransientVector& operator=(const TransientVector&) = delete;
+    TransientVector(TransientVector&&) noexcept = default;
+    TransientVector& operator=(TransientVector&&) noexcept = default;
+
+    size_t GetSize() const noexcept {
+        return tree_.GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return tree_.Get(index);
+    }
+
+    void Set(size_t index, Type value) {
+        if (index >= GetSize()) {
+            throw std::out_of_range("Method Set(index): index >= size");
+        }
+        tree_.Set(index, std::move(value));
+    }
+
+    void PushBack(const Type& item) {
+        tree_.EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        tree_.EmplaceBack(std::move(item));
+    }
+
+    template <typename... Args>
+    void EmplaceBack(Args&&... args) {
+        tree_.EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    void PopBack() {
+        assert(!IsEmpty());
+        tree_.PopBack();
+    }
+
+    void Append(const PersistentVector<Type>& other) {
+        tree_.Append(other.tree_);
+    }
+
+    PersistentVector<Type> Persistent() && noexcept {
+        return PersistentVector<Type>(std::move(tree_));
+    }
+
+private:
+    detail::PersistentTree<Type> tree_;
+};
+
+template <typename Type>
+bool operator==(const PersistentVector<Type>& lhs, const PersistentVector<Type>& rhs) {
+    if (lhs.GetSize() != rhs.GetSize()) {
+        return false;
+    }
+    return lhs.SharesWith(rhs) || std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename Type>
+bool operator!=(const PersistentVector<Type>& lhs, const PersistentVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
@@ -0,0 +1,422 @@
+#pragma once
+
+#include <bit>
+#include <cstdlib>
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+
+#include "array_ptr.h"
+#include "memory_utils.h"
+#include "simple_vector.h"
+
+namespace detail {
+
+// Блок по умолчанию занимает около 64 КиБ
+template <typename Type>
+inline constexpr size_t kDefaultSegmentBlockSize = std::bit_floor(std::max<size_t>(1, 65536 / sizeof(Type)));
+
+}  // namespace detail
+
+// Вектор из блоков фиксированного размера: при заполнении добавляется новый блок, а уже созданные
+// элементы никогда не переезжают. Рост не даёт ни скачков задержки на перенос всех элементов,
+// ни временного пика памяти; перевыделяется только таблица указателей на блоки.
+// operator[] стоит сдвиг и маску. Ссылки на элементы остаются действительными до удаления
+// самих элементов. Compact() собирает элементы в непрерывный SimpleVector
+template <typename Type, typename Allocator = std::allocator<Type>,
+          size_t BlockSize = detail::kDefaultSegmentBlockSize<Type>>
+class SegmentedVector {
+    static_assert(std::has_single_bit(BlockSize), "block size must be a power of two");
+
+    static constexpr size_t kBlockShift = std::countr_zero(BlockSize);
+    static constexpr size_t kBlockMask = BlockSize - 1;
+
+    using Block = ArrayPtr<Type, Allocator>;
+
+    template <bool Const>
+    class BasicIterator;
+
+public:
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    static constexpr size_t kBlockSize = BlockSize;
+
+    SegmentedVector() noexcept(noexcept(Allocator())) = default;
+
+    explicit SegmentedVector(const Allocator& alloc) noexcept
+            : alloc_(alloc)
+    {
+    }
+
+    explicit SegmentedVector(size_t size, const Allocator& alloc = Allocator())
+            : alloc_(alloc)
+    {
+        Resize(size);
+    }
+
+    SegmentedVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+            : alloc_(alloc)
+    {
+        Reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            PushBack(value);
+        }
+    }
+
+    SegmentedVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+            : alloc_(alloc)
+    {
+        Reserve(init.size());
+        for (const Type& item : init) {
+            PushBack(item);
+        }
+    }
+
+    SegmentedVector(const SegmentedVector& other)
+            : alloc_(std::allocator_traits<Allocator>::select_on_container_copy_construction(other.alloc_))
+    {
+        Reserve(other.size_);
+        for (const Type& item : other) {
+            PushBack(item);
+        }
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            SegmentedVector tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept
+            : alloc_(other.alloc_)
+            , blocks_(std::move(other.blocks_))
+            , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            SegmentedVector tmp(std::move(rhs));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    ~SegmentedVector() {
+        Clear();
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Число элементов в уже выделенных блоках
+    size_t GetCapacity() const noexcept {
+        return blocks_.GetSize() * BlockSize;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    size_t GetBlockCount() const noexcept {
+        return blocks_.GetSize();
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return *Slot(index);
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return *Slot(index);
+    }
+
+    Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return *Slot(index);
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return *Slot(index);
+    }
+
+    Iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    Iterator end() noexcept {
+        return {this, size_};
+    }
+
+    ConstIterator begin() const noexcept {
+        return {this, 0};
+    }
+
+    ConstIterator end() const noexcept {
+        return {this, size_};
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Элементы не переезжают при росте, поэтому аргументы могут ссылаться на элементы вектора
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if (size_ == GetCapacity()) {
+            AddBlock();
+        }
+        Type* const slot = Slot(size_);
+        detail::Construct(alloc_, slot, std::forward<Args>(args)...);
+        ++size_;
+        return *slot;
+    }
+
+    void PopBack() noexcept {
+        assert(size_ > 0);
+        --size_;
+        detail::Destroy(alloc_, Slot(size_));
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size < size_) {
+            DestroyTail(new_size);
+            return;
+        }
+        Reserve(new_size);
+        while (size_ < new_size) {
+            if constexpr (detail::kDefaultConstruct<Allocator, Type>) {
+                ::new (static_cast<void*>(Slot(size_))) Type();
+            } else {
+                std::allocator_traits<Allocator>::construct(alloc_, Slot(size_));
+            }
+            ++size_;
+        }
+    }
+
+    // Выделяет блоки под new_capacity элементов
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= GetCapacity()) {
+            return;
+        }
+        const size_t block_count = (new_capacity + kBlockMask) >> kBlockShift;
+        blocks_.Reserve(block_count);
+        while (blocks_.GetSize() < block_count) {
+            AddBlock();
+        }
+    }
+
+    // Разрушает элементы, выделенные блоки остаются для повторного использования
+    void Clear() noexcept {
+        DestroyTail(0);
+    }
+
+    // Возвращает аллокатору блоки, в которых нет элементов
+    void ShrinkToFit() noexcept {
+        const size_t used = (size_ + kBlockMask) >> kBlockShift;
+        while (blocks_.GetSize() > used) {
+            blocks_.PopBack();
+        }
+    }
+
+    // Переносит элементы в непрерывный SimpleVector и очищает этот вектор, освобождая блоки.
+    // Если перенос бросает исключение, этот вектор не меняется
+    SimpleVector<Type, Allocator> Compact() {
+        SimpleVector<Type, Allocator> result = SimpleVector<Type, Allocator>::FromUninitialized(
+                size_, [this](Type* data, size_t size) {
+                    size_t done = 0;
+                    try {
+                        for (; done < size; done += BlockSize) {
+                            const size_t count = std::min(BlockSize, size - done);
+                            if constexpr (detail::kRelocateBitwise<Allocator, Type>) {
+                                detail::RelocateBitwise(blocks_[done >> kBlockShift].Get(), count, data + done);
+                            } else {
+                                detail::UninitializedRelocateN(alloc_, blocks_[done >> kBlockShift].Get(), count,
+                                                               data + done);
+                            }
+                        }
+                    } catch (...) {
+                        detail::DestroyN(alloc_, data, done);
+                        throw;
+                    }
+                }, alloc_);
+        if constexpr (!detail::kRelocateBitwise<Allocator, Type>) {
+            Clear();
+        }
+        size_ = 0;
+        blocks_.Clear();
+        return result;
+    }
+
+    void swap(SegmentedVector& other) noexcept {
+        using std::swap;
+        if constexpr (std::allocator_traits<Allocator>::propagate_on_container_swap::value) {
+            swap(alloc_, other.alloc_);
+        }
+        blocks_.swap(other.blocks_);
+        swap(size_, other.size_);
+    }
+
+private:
+    [[no_unique_address]] Allocator alloc_;
+    SimpleVector<Block> blocks_;
+    size_t size_ = 0;
+
+    Type* Slot(size_t index) const noexcept {
+        return blocks_[index >> kBlockShift].Get() + (index & kBlockMask);
+    }
+
+    void AddBlock() {
+        Block block(BlockSize, alloc_);
+        blocks_.PushBack(std::move(block));
+    }
+
+    void DestroyTail(size_t new_size) noexcept {
+        while (size_ > new_size) {
+            // разрушаем по блокам, с конца
+            const size_t first = std::max(new_size, (size_ - 1) & ~kBlockMask);
+            detail::DestroyN(alloc_, Slot(first), size_ - first);
+            size_ = first;
+        }
+    }
+
+    template <bool Const>
+    class BasicIterator {
+        using Owner = std::conditional_t<Const, const SegmentedVector, SegmentedVector>;
+
+    public:
+        using iterator_category = std::random_access_iterator_tag;
+        using value_type = Type;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, const Type&, Type&>;
+        using pointer = std::conditional_t<Const, const Type*, Type*>;
+
+        BasicIterator() noexcept = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+                : owner_(owner)
+                , index_(index)
+        {
+        }
+
+        operator BasicIterator<true>() const noexcept requires(!Const) {
+            return {owner_, index_};
+        }
+
+        reference operator*() const noexcept {
+            return *owner_->Slot(index_);
+        }
+
+        pointer operator->() const noexcept {
+            return owner_->Slot(index_);
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return *owner_->Slot(index_ + n);
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator old = *this;
+            --index_;
+            return old;
+        }
+
+        BasicIterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend BasicIterator operator+(difference_type n, BasicIterator it) noexcept {
+            return it += n;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend auto operator<=>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+};
+
+template <typename Type, typename Allocator, size_t BlockSize>
+bool operator==(const SegmentedVector<Type, Allocator, BlockSize>& lhs,
+                const SegmentedVector<Type, Allocator, BlockSize>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename Type, typename Allocator, size_t BlockSize>
+bool operator!=(const SegmentedVector<Type, Allocator, BlockSize>& lhs,
+                const SegmentedVector<Type, Allocator, BlockSize>& rhs) {
+    return !(lhs == rhs);
+}
@@ -0,0 +1,154 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "parallel_algorithms.h"
+#include "simple_vector.h"
+
+// Собирает элементы из многих потоков без общей точки синхронизации: у каждого потока свой
+// SimpleVector (шард), а MergeInto переносит все шарды в итоговый вектор за одно перераспределение,
+// параллельно и каждый шард по заранее вычисленному смещению.
+// Добавления из разных потоков можно вести одновременно; MergeInto, GetSize и разрушение
+// вызываются, когда добавления закончены
+template <typename Type>
+class ShardedAppender {
+public:
+    ShardedAppender() = default;
+
+    ShardedAppender(const ShardedAppender&) = delete;
+    ShardedAppender& operator=(const ShardedAppender&) = delete;
+
+    // Шард вызывающего потока. Первое обращение потока регистрирует шард под мьютексом,
+    // дальше он берётся из кэша потока
+    SimpleVector<Type>& Local() {
+        thread_local LocalCache cache;
+        if (cache.owner_id != id_) {
+            cache.shard = &FindOrCreateShard();
+            cache.owner_id = id_;
+        }
+        return *cache.shard;
+    }
+
+    void PushBack(const Type& item) {
+        Local().PushBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        Local().PushBack(std::move(item));
+    }
+
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        return Local().EmplaceBack(std::forward<Args>(args)...);
+    }
+
+    size_t GetSize() const {
+        std::lock_guard lock(mutex_);
+        size_t size = 0;
+        for (const auto& shard : shards_) {
+            size += shard->items.GetSize();
+        }
+        return size;
+    }
+
+    size_t GetShardCount() const {
+        std::lock_guard lock(mutex_);
+        return shards_.size();
+    }
+
+    // Переносит элементы всех шардов в конец dest (шарды - в порядке регистрации потоков).
+    // Шарды опустошаются, но сохраняют память для следующего раунда
+    void MergeInto(SimpleVector<Type>& dest, const ParallelOptions& options = {}) {
+        std::lock_guard lock(mutex_);
+        std::vector<size_t> offsets(shards_.size() + 1, 0);
+        for (size_t i = 0; i < shards_.size(); ++i) {
+            offsets[i + 1] = offsets[i] + shards_[i]->items.GetSize();
+        }
+        const size_t total = offsets.back();
+
+        dest.AppendUninitialized(total, [&](Type* data, size_t) {
+            const auto move_shard = [&](size_t i) {
+                SimpleVector<Type>& items = shards_[i]->items;
+                std::uninitialized_move(items.begin(), items.end(), data + offsets[i]);
+            };
+            if (total < options.sequential_threshold || shards_.size() < 2) {
+                MoveShardsSequentially(data, offsets, move_shard);
+            } else {
+                MoveShardsInParallel(data, offsets, move_shard, detail::GetPool(options));
+            }
+        });
+        for (auto& shard : shards_) {
+            shard->items.Clear();
+        }
+    }
+
+private:
+    // Шард на своей кэш-строке, чтобы потоки не делили строки с размером соседнего шарда
+    struct alignas(detail::kCacheLineSize) Shard {
+        SimpleVector<Type> items;
+    };
+
+    struct LocalCache {
+        uint64_t owner_id = 0;
+        SimpleVector<Type>* shard = nullptr;
+    };
+
+    // Идентификатор вместо адреса: новый объект по адресу разрушенного не должен попасть в кэш потоков
+    static inline std::atomic<uint64_t> next_id_ = 1;
+
+    const uint64_t id_ = next_id_.fetch_add(1, std::memory_order_relaxed);
+    mutable std::mutex mutex_;
+    std::vector<std::unique_ptr<Shard>> shards_;
+    std::unordered_map<std::thread::id, Shard*> by_thread_;
+
+    SimpleVector<Type>& FindOrCreateShard() {
+        std::lock_guard lock(mutex_);
+        Shard*& shard = by_thread_[std::this_thread::get_id()];
+        if (shard == nullptr) {
+            shards_.push_back(std::make_unique<Shard>());
+            shard = shards_.back().get();
+        }
+        return shard->items;
+    }
+
+    // При исключении разрушает уже перенесённые шарды
+    template <typename MoveShard>
+    void MoveShardsSequentially(Type* data, const std::vector<size_t>& offsets, const MoveShard& move_shard) {
+        size_t i = 0;
+        try {
+            for (; i < shards_.size(); ++i) {
+                move_shard(i);
+            }
+        } catch (...) {
+            std::destroy_n(data, offsets[i]);
+            throw;
+        }
+    }
+
+    template <typename MoveShard>
+    void MoveShardsInParallel(Type* data, const std::vector<size_t>& offsets, const MoveShard& move_shard,
+                              ThreadPool& pool) {
+        const std::unique_ptr<bool[]> done(new bool[shards_.size()]());
+        try {
+            pool.ParallelFor(shards_.size(), [&](size_t i) {
+                move_shard(i);
+                done[i] = true;
+            });
+        } catch (...) {
+            for (size_t i = 0; i < shards_.size(); ++i) {
+                if (done[i]) {
+                    std::destroy(data + offsets[i], data + offsets[i + 1]);
+                }
+            }
+            throw;
+        }
+    }
+};
@@ -0,0 +1,213 @@
+#pragma once
+
+#include <cstdlib>
+#include <stdexcept>
+#include <cassert>
+#include <type_traits>
+
+#include "array_ptr.h"
+#include "compare_ops.h"
+#include "simple_vector.h"
+#include "static_vector.h"
+
+namespace detail {
+
+// Как у std::span: допустимо только добавление const/volatile к элементам
+template <typename From, typename To>
+inline constexpr bool kSpanConvertible = std::is_convertible_v<From (*)[], To (*)[]>;
+
+}  // namespace detail
+
+// Невладеющий вид на непрерывный диапазон элементов: указатель и длина.
+// Subspan, First и Last режут диапазон без копирования. SimpleSpan<const Type> - вид только для чтения.
+// Вид действителен, пока жив и не перевыделялся контейнер, из которого он получен
+template <typename Type>
+class SimpleSpan {
+public:
+    using ValueType = std::remove_cv_t<Type>;
+    using Iterator = Type*;
+
+    constexpr SimpleSpan() noexcept = default;
+
+    constexpr SimpleSpan(Type* data, size_t size) noexcept
+            : data_(data)
+            , size_(size)
+    {
+    }
+
+    template <typename Other, typename Allocator, typename GrowthPolicy>
+        requires detail::kSpanConvertible<Other, Type>
+    SimpleSpan(SimpleVector<Other, Allocator, GrowthPolicy>& vector) noexcept
+            : SimpleSpan(vector.Data(), vector.GetSize())
+    {
+    }
+
+    template <typename Other, typename Allocator, typename GrowthPolicy>
+        requires detail::kSpanConvertible<const Other, Type>
+    SimpleSpan(const SimpleVector<Other, Allocator, GrowthPolicy>& vector) noexcept
+            : SimpleSpan(vector.Data(), vector.GetSize())
+    {
+    }
+
+    template <typename Other, size_t N>
+        requires detail::kSpanConvertible<Other, Type>
+    constexpr SimpleSpan(StaticVector<Other, N>& vector) noexcept
+            : SimpleSpan(vector.begin(), vector.GetSize())
+    {
+    }
+
+    template <typename Other, size_t N>
+        requires detail::kSpanConvertible<const Other, Type>
+    constexpr SimpleSpan(const StaticVector<Other, N>& vector) noexcept
+            : SimpleSpan(vector.begin(), vector.GetSize())
+    {
+    }
+
+    // ArrayPtr не знает, сколько элементов в нём построено, поэтому их число передаётся явно
+    template <typename Other, typename Allocator>
+        requires detail::kSpanConvertible<Other, Type>
+    SimpleSpan(const ArrayPtr<Other, Allocator>& items, size_t size) noexcept
+            : SimpleSpan(items.Get(), size)
+    {
+        assert(size <= items.GetSize());
+    }
+
+    template <typename Other>
+        requires(detail::kSpanConvertible<Other, Type> && !std::is_same_v<Other, Type>)
+    constexpr SimpleSpan(const SimpleSpan<Other>& other) noexcept
+            : SimpleSpan(other.Get(), other.GetSize())
+    {
+    }
+
+    constexpr Type* Get() const noexcept {
+        return data_;
+    }
+
+    constexpr size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    constexpr bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    constexpr Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    constexpr Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return data_[index];
+    }
+
+    constexpr Iterator begin() const noexcept {
+        return data_;
+    }
+
+    constexpr Iterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    // count элементов, начиная с offset
+    constexpr SimpleSpan Subspan(size_t offset, size_t count) const noexcept {
+        assert(offset <= size_ && count <= size_ - offset);
+        return {data_ + offset, count};
+    }
+
+    // Элементы, начиная с offset, до конца
+    constexpr SimpleSpan Subspan(size_t offset) const noexcept {
+        assert(offset <= size_);
+        return {data_ + offset, size_ - offset};
+    }
+
+    constexpr SimpleSpan First(size_t count) const noexcept {
+        assert(count <= size_);
+        return {data_, count};
+    }
+
+    constexpr SimpleSpan Last(size_t count) const noexcept {
+        assert(count <= size_);
+        return {data_ + size_ - count, count};
+    }
+
+    Iterator Find(const ValueType& value) const {
+        return data_ + detail::FindIndex(static_cast<const ValueType*>(data_), size_, value);
+    }
+
+    bool Contains(const ValueType& value) const {
+        return Find(value) != end();
+    }
+
+    size_t Count(const ValueType& value) const {
+        return detail::CountEqual(static_cast<const ValueType*>(data_), size_, value);
+    }
+
+    // Как SimpleVector::Prefetch
+    void Prefetch(size_t index, PrefetchHint hint = PrefetchHint::kRead) const noexcept {
+        if (index < size_) {
+            detail::PrefetchAddress(data_ + index, hint);
+        }
+    }
+
+private:
+    Type* data_ = nullptr;
+    size_t size_ = 0;
+};
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+SimpleSpan(SimpleVector<Type, Allocator, GrowthPolicy>&) -> SimpleSpan<Type>;
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+SimpleSpan(const SimpleVector<Type, Allocator, GrowthPolicy>&) -> SimpleSpan<const Type>;
+
+template <typename Type, size_t N>
+SimpleSpan(StaticVector<Type, N>&) -> SimpleSpan<Type>;
+
+template <typename Type, size_t N>
+SimpleSpan(const StaticVector<Type, N>&) -> SimpleSpan<const Type>;
+
+template <typename Type, typename Allocator>
+SimpleSpan(const ArrayPtr<Type, Allocator>&, size_t) -> SimpleSpan<Type>;
+
+template <typename Lhs, typename Rhs>
+    requires std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>
+bool operator==(SimpleSpan<Lhs> lhs, SimpleSpan<Rhs> rhs) {
+    using Type = std::remove_cv_t<Lhs>;
+    return lhs.GetSize() == rhs.GetSize() &&
+           detail::EqualRanges(static_cast<const Type*>(lhs.Get()), static_cast<const Type*>(rhs.Get()), lhs.GetSize());
+}
+
+template <typename Lhs, typename Rhs>
+    requires std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>
+bool operator!=(SimpleSpan<Lhs> lhs, SimpleSpan<Rhs> rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Lhs, typename Rhs>
+    requires std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>
+bool operator<(SimpleSpan<Lhs> lhs, SimpleSpan<Rhs> rhs) {
+    using Type = std::remove_cv_t<Lhs>;
+    return detail::LessRanges(static_cast<const Type*>(lhs.Get()), lhs.GetSize(),
+                              static_cast<const Type*>(rhs.Get()), rhs.GetSize());
+}
+
+template <typename Lhs, typename Rhs>
+    requires std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>
+bool operator<=(SimpleSpan<Lhs> lhs, SimpleSpan<Rhs> rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Lhs, typename Rhs>
+    requires std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>
+bool operator>(SimpleSpan<Lhs> lhs, SimpleSpan<Rhs> rhs) {
+    return rhs < lhs;
+}
+
+template <typename Lhs, typename Rhs>
+    requires std::is_same_v<std::remove_cv_t<Lhs>, std::remove_cv_t<Rhs>>
+bool operator>=(SimpleSpan<Lhs> lhs, SimpleSpan<Rhs> rhs) {
+    return !(lhs < rhs);
+}
@@ -2,12 +2,22 @@
 
 #include <cstdlib>
 #include <initializer_list>
+#include <iterator>
 #include <stdexcept>
 #include <algorithm>
 #include <cassert>
+#include <memory>
+#include <memory_resource>
+#include <type_traits>
 #include <utility>
 
 #include "array_ptr.h"
+#include "compare_ops.h"
+#include "growth_policy.h"
+#include "memory_utils.h"
+#include "vector_checks.h"
+#include "vector_stats.h"
+#include "vector_ops.h"
 
 
 class ReserveProxyObj {
@@ -25,102 +35,239 @@ private:
     size_t reserve_capacity_ = 0;
 };
 
-ReserveProxyObj Reserve(size_t capacity_to_reserve) {
+inline ReserveProxyObj Reserve(size_t capacity_to_reserve) {
     return ReserveProxyObj(capacity_to_reserve);
 }
 
-template <typename Type>
+template <typename Type, typename Allocator = std::allocator<Type>, typename GrowthPolicy = DefaultGrowthPolicy>
 class SimpleVector {
+    using AllocTraits = std::allocator_traits<Allocator>;
+
 public:
+#ifdef SIMPLE_VECTOR_CHECKED
+    using Iterator = detail::CheckedIterator<SimpleVector, Type>;
+    using ConstIterator = detail::CheckedIterator<SimpleVector, const Type>;
+#else
     using Iterator = Type*;
     using ConstIterator = const Type*;
+#endif
+    using AllocatorType = Allocator;
+    using GrowthPolicyType = GrowthPolicy;
 
-    SimpleVector() noexcept = default;
+    SimpleVector() noexcept(noexcept(Allocator())) = default;
 
-    explicit SimpleVector(size_t size)
-            : items_(size)
-            , size_(size)
-            , capacity_(size)
+    explicit SimpleVector(const Allocator& alloc) noexcept
+            : items_(alloc)
     {
-        std::fill(begin(), end(), std::move(Type()));
     }
 
-    SimpleVector(size_t size, const Type& value)
-            : items_(size)
-            , size_(size)
-            , capacity_(size)
+    explicit SimpleVector(size_t size, const Allocator& alloc = Allocator())
+            : items_(size, alloc)
     {
-        std::fill(begin(), end(), value);
+        detail::UninitializedValueConstructN(items_.GetAllocator(), items_.Get(), size);
+        size_ = size;
+        CountAllocation();
     }
 
-    SimpleVector(std::initializer_list<Type> init)
-            : items_(init.size())
-            , size_(init.size())
-            , capacity_(init.size())
+    SimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+            : items_(size, alloc)
     {
-        int i = 0;
-        for (auto& val : init) {
-            items_[i++] = std::move(val);
-        }
+        detail::UninitializedFillN(items_.GetAllocator(), items_.Get(), size, value);
+        size_ = size;
+        CountAllocation();
+        stats_.OnCopy(size);
+    }
+
+    SimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+            : items_(init.size(), alloc)
+    {
+        detail::UninitializedCopy(items_.GetAllocator(), init.begin(), init.end(), items_.Get());
+        size_ = init.size();
+        CountAllocation();
+        stats_.OnCopy(size_);
     }
 
     SimpleVector(const SimpleVector& other)
-            : SimpleVector(other.size_)
+            : SimpleVector(other, AllocTraits::select_on_container_copy_construction(other.GetAllocator()))
+    {
+    }
+
+    SimpleVector(const SimpleVector& other, const Allocator& alloc)
+            : items_(other.size_, alloc)
     {
-        ArrayPtr<Type> tmp(other.size_);
-        std::copy(other.begin(), other.end(), &tmp[0]);
-        tmp.swap(items_);
+        detail::UninitializedCopy(items_.GetAllocator(), other.Data(), other.Data() + other.size_, items_.Get());
+        size_ = other.size_;
+        CountAllocation();
+        stats_.OnCopy(size_);
     }
 
     SimpleVector& operator=(const SimpleVector& rhs) {
-        assert(&rhs.items_[0] != &items_[0]); // запрещаем самоприсваивание
+        if (this == &rhs) {
+            return *this;
+        }
+
+        generation_.Bump();
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (GetAllocator() != rhs.GetAllocator()) {
+                // память, выделенную старым аллокатором, нужно вернуть ему же
+                Clear();
+                items_ = ArrayPtr<Type, Allocator>(rhs.GetAllocator());
+            }
+        }
 
-        ArrayPtr<Type> tmp(rhs.size_);
-        std::copy(rhs.begin(), rhs.end(), &tmp[0]);
-        tmp.swap(items_);
+        stats_.OnCopy(rhs.size_);
+        if (rhs.size_ > GetCapacity()) {
+            ArrayPtr<Type, Allocator> tmp(rhs.size_, items_.GetAllocator());
+            detail::UninitializedCopy(tmp.GetAllocator(), rhs.Data(), rhs.Data() + rhs.size_, tmp.Get());
+            Clear();
+            items_.swap(tmp);
+            size_ = rhs.size_;
+            CountAllocation();
+            return *this;
+        }
+
+        // памяти хватает - переиспользуем уже сконструированные элементы
+        if (rhs.size_ <= size_) {
+            std::copy_n(rhs.items_.Get(), rhs.size_, items_.Get());
+            detail::DestroyN(items_.GetAllocator(), items_.Get() + rhs.size_, size_ - rhs.size_);
+        } else {
+            std::copy_n(rhs.items_.Get(), size_, items_.Get());
+            detail::UninitializedCopy(items_.GetAllocator(), rhs.Data() + size_, rhs.Data() + rhs.size_,
+                                      items_.Get() + size_);
+        }
         size_ = rhs.size_;
-        capacity_ = rhs.capacity_;
         return *this;
     }
 
-    SimpleVector(SimpleVector&& other) {
-        items_ = std::move(other.items_);
-        size_ = std::exchange(other.size_, 0);
-        capacity_ = std::exchange(other.capacity_, 0);
+    SimpleVector(SimpleVector&& other) noexcept
+            : items_(std::move(other.items_))
+            , size_(std::exchange(other.size_, 0))
+    {
+        other.generation_.Bump();
     }
 
-    SimpleVector& operator=(SimpleVector&& rhs) {
-        items_ = std::move(rhs.items_);
-        size_ = std::exchange(rhs.size_, 0);
-        capacity_ = std::exchange(rhs.capacity_, 0);
+    SimpleVector(SimpleVector&& other, const Allocator& alloc)
+            : items_(alloc)
+    {
+        other.generation_.Bump();
+        if (alloc == other.GetAllocator()) {
+            items_ = std::move(other.items_);
+            size_ = std::exchange(other.size_, 0);
+        } else {
+            MoveElementsFrom(other);
+        }
+    }
+
+    SimpleVector& operator=(SimpleVector&& rhs) noexcept(
+            AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+        if (this == &rhs) {
+            return *this;
+        }
+
+        Clear();
+        rhs.generation_.Bump();
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+            items_ = std::move(rhs.items_);
+            size_ = std::exchange(rhs.size_, 0);
+        } else {
+            if (GetAllocator() == rhs.GetAllocator()) {
+                items_ = std::move(rhs.items_);
+                size_ = std::exchange(rhs.size_, 0);
+            } else {
+                // память чужого аллокатора забрать нельзя - переносим элементы поштучно
+                MoveElementsFrom(rhs);
+            }
+        }
         return *this;
     }
 
-    SimpleVector(const ReserveProxyObj& obj)
-            : SimpleVector()
+    SimpleVector(const ReserveProxyObj& obj, const Allocator& alloc = Allocator())
+            : SimpleVector(alloc)
     {
         Reserve(obj.GetCapacity());
     }
 
+    // Создаёт вектор из size элементов, которые init(data, size) конструирует в ещё не
+    // инициализированном блоке. Если init бросает исключение, она сама разрушает созданные ею элементы
+    template <typename Init>
+    static SimpleVector FromUninitialized(size_t size, Init&& init, const Allocator& alloc = Allocator()) {
+        SimpleVector result(alloc);
+        if (size != 0) {
+            ArrayPtr<Type, Allocator> tmp(size, result.items_.GetAllocator());
+            init(tmp.Get(), size);
+            result.items_.swap(tmp);
+            result.size_ = size;
+            result.CountAllocation();
+        }
+        return result;
+    }
+
+    ~SimpleVector() {
+        detail::DestroyN(items_.GetAllocator(), items_.Get(), size_);
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return items_.GetAllocator();
+    }
+
+    // Счётчики этого вектора; нули, если SIMPLE_VECTOR_STATS не определён
+    VectorStats GetStats() const noexcept {
+        return stats_.Get();
+    }
+
     size_t GetSize() const noexcept {
         return size_;
     }
 
     size_t GetCapacity() const noexcept {
-        return capacity_;
+        return items_.GetSize();
     }
 
     bool IsEmpty() const noexcept {
         return size_ == 0;
     }
 
-    Type& operator[](size_t index) noexcept {
-        assert(index < size_);
+    // Указатель на элементы. В отличие от begin() это обычный указатель и в проверяемом режиме
+    Type* Data() noexcept {
+        return items_.Get();
+    }
+
+    const Type* Data() const noexcept {
+        return items_.Get();
+    }
+
+    // Первый элемент, равный value, или end(). Для целых типов поиск идёт SIMD-блоками
+    Iterator Find(const Type& value) {
+        return IteratorAt(detail::FindIndex(items_.Get(), size_, value));
+    }
+
+    ConstIterator Find(const Type& value) const {
+        return IteratorAt(detail::FindIndex(items_.Get(), size_, value));
+    }
+
+    bool Contains(const Type& value) const {
+        return Find(value) != end();
+    }
+
+    size_t Count(const Type& value) const {
+        return detail::CountEqual(items_.Get(), size_, value);
+    }
+
+    // Заранее подтягивает в кеш элемент index, к которому цикл обратится через несколько итераций.
+    // Индекс за пределами вектора игнорируется, поэтому можно не проверять конец цикла
+    void Prefetch(size_t index, PrefetchHint hint = PrefetchHint::kRead) const noexcept {
+        if (index < size_) {
+            detail::PrefetchAddress(items_.Get() + index, hint);
+        }
+    }
+
+    Type& operator[](size_t index) noexcept(!detail::kVectorChecksEnabled) {
+        CheckIndex(index);
         return items_[index];
     }
 
-    const Type& operator[](size_t index) const noexcept {
-        assert(index < size_);
+    const Type& operator[](size_t index) const noexcept(!detail::kVectorChecksEnabled) {
+        CheckIndex(index);
         return items_[index];
     }
 
@@ -139,45 +286,72 @@ public:
     }
 
     void Clear() noexcept {
+        detail::DestroyN(items_.GetAllocator(), items_.Get(), size_);
         size_ = 0;
+        generation_.Bump();
+    }
+
+    // Очищает вектор; при release_memory == true ещё и возвращает память аллокатору
+    void Clear(bool release_memory) noexcept {
+        Clear();
+        if (release_memory) {
+            ArrayPtr<Type, Allocator> empty(items_.GetAllocator());
+            items_.swap(empty);
+        }
+    }
+
+    // Уменьшает вместимость до размера, возвращая лишнюю память аллокатору
+    void ShrinkToFit() {
+        if (size_ == GetCapacity()) {
+            return;
+        }
+        if (size_ == 0) {
+            Clear(true);
+            return;
+        }
+        Reallocate(size_);
     }
 
     void Resize(size_t new_size) {
         if (new_size <= size_) {
+            detail::DestroyN(items_.GetAllocator(), items_.Get() + new_size, size_ - new_size);
             size_ = new_size;
             return;
         }
 
-        if (size_ < new_size && new_size <= capacity_) {
+        const size_t count = new_size - size_;
+        if (new_size <= GetCapacity()) {
+            detail::UninitializedValueConstructN(items_.GetAllocator(), items_.Get() + size_, count);
             size_ = new_size;
             return;
         }
 
-        if (new_size > capacity_) {
-            size_t new_capacity = std::max(new_size, 2 * capacity_);
-            ArrayPtr<Type> tmp(new_capacity);
-            std::copy(std::make_move_iterator(begin()), std::make_move_iterator(end()), &tmp[0]);
-            tmp.swap(items_);
-            size_ = new_size;
-            capacity_ = new_capacity;
-            return;
+        const size_t new_capacity = NextCapacity(new_size);
+        if constexpr (kUseReallocate) {
+            Reallocate(new_capacity);
+            detail::UninitializedValueConstructN(items_.GetAllocator(), items_.Get() + size_, count);
+        } else {
+            ReallocateWithGap(new_capacity, size_, count, [this, count](Type* gap) {
+                detail::UninitializedValueConstructN(items_.GetAllocator(), gap, count);
+            });
         }
+        size_ = new_size;
     }
 
     Iterator begin() noexcept {
-        return size_ == 0 ? nullptr : &items_[0];
+        return IteratorAt(0);
     }
 
     Iterator end() noexcept {
-        return size_ == 0 ? nullptr : &items_[0] + size_;
+        return IteratorAt(size_);
     }
 
     ConstIterator begin() const noexcept {
-        return size_ == 0 ? nullptr : &items_[0];
+        return IteratorAt(0);
     }
 
     ConstIterator end() const noexcept {
-        return size_ == 0 ? nullptr : &items_[0] + size_;
+        return IteratorAt(size_);
     }
 
     ConstIterator cbegin() const noexcept {
@@ -188,109 +362,363 @@ public:
         return end();
     }
 
-    void PushBack(Type item) {
-        if (size_ != capacity_) {
-            items_[size_++] = std::move(item);
-            return;
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Конструирует элемент прямо в конце вектора, аргументы могут ссылаться на его элементы
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if (size_ != GetCapacity()) {
+            detail::Construct(items_.GetAllocator(), items_.Get() + size_, std::forward<Args>(args)...);
+        } else if constexpr (kUseReallocate && std::is_nothrow_move_constructible_v<Type>) {
+            // после reallocate аргументы, ссылающиеся на элементы, станут висячими - сначала создаём значение
+            Type value(std::forward<Args>(args)...);
+            Reallocate(NextCapacity(size_ + 1));
+            detail::Construct(items_.GetAllocator(), items_.Get() + size_, std::move(value));
+        } else {
+            const size_t new_capacity = NextCapacity(size_ + 1);
+            ReallocateWithGap(new_capacity, size_, 1, [&](Type* gap) {
+                detail::Construct(items_.GetAllocator(), gap, std::forward<Args>(args)...);
+            });
         }
+        return items_[size_++];
+    }
 
-        const size_t new_capacity = std::max(2 * capacity_, size_t(1));
-        ArrayPtr<Type> tmp(new_capacity);
-        std::copy(std::make_move_iterator(begin()), std::make_move_iterator(end()), &tmp[0]);
-        tmp[size_] = std::move(item);
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
 
-        tmp.swap(items_);
-        ++size_;
-        capacity_ = new_capacity;
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
     }
 
-    Iterator Insert(ConstIterator pos, Type value) {
+    // Конструирует элемент перед pos. Вставка в конец и вставка с переездом в новое хранилище
+    // конструируют элемент сразу на месте, вставка в середину - через временный объект
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
         assert(pos >= begin() && pos <= end());
-        if (size_ != capacity_) {
-            auto p = pos - begin();
-            std::copy_backward(std::make_move_iterator(begin() + p), std::make_move_iterator(end()), end() + 1);
-            items_[p] = std::move(value);
-            ++size_;
-            return begin() + p;
+        const size_t p = pos - begin();
+
+        if (p == size_) {
+            EmplaceBack(std::forward<Args>(args)...);
+            return IteratorAt(p);
         }
 
-        auto p = pos - begin();
-        size_t new_capacity = std::max(2 * capacity_, size_t(1));
-        ArrayPtr<Type> tmp(new_capacity);
-        std::copy(std::make_move_iterator(begin()), std::make_move_iterator(begin() + p), &tmp[0]);
-        tmp[p] = std::move(value);
+        if (size_ != GetCapacity()) {
+            // временный объект нужен до сдвига: аргументы могут ссылаться на сдвигаемые элементы
+            Type value(std::forward<Args>(args)...);
+            stats_.OnMove(size_ - p);
+            detail::InsertInPlace(items_.GetAllocator(), items_.Get(), size_, p, std::move(value));
+            generation_.Bump();
+            return IteratorAt(p);
+        }
 
-        std::copy_backward(std::make_move_iterator(begin() + p), std::make_move_iterator(end()), &tmp[size_] + 1);
-        tmp.swap(items_);
-        capacity_ = new_capacity;
+        const size_t new_capacity = NextCapacity(size_ + 1);
+        ReallocateWithGap(new_capacity, p, 1, [&](Type* gap) {
+            detail::Construct(items_.GetAllocator(), gap, std::forward<Args>(args)...);
+        });
         ++size_;
-        return begin() + p;
+        return IteratorAt(p);
+    }
+
+    // Вставляет копии элементов [first, last) перед pos. Для forward-итераторов итоговый размер
+    // известен заранее: не больше одного перевыделения и один сдвиг хвоста.
+    // Диапазон не должен указывать на элементы самого вектора
+    template <typename InputIt>
+    Iterator InsertRange(ConstIterator pos, InputIt first, InputIt last) {
+        assert(pos >= begin() && pos <= end());
+        const size_t p = pos - begin();
+
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            const size_t count = std::distance(first, last);
+            if (count == 0) {
+                return IteratorAt(p);
+            }
+            stats_.OnCopy(count);
+            const size_t new_size = GrownSize(count);
+            if (new_size > GetCapacity()) {
+                ReallocateWithGap(NextCapacity(new_size), p, count, [&](Type* gap) {
+                    detail::UninitializedCopy(items_.GetAllocator(), first, last, gap);
+                });
+                size_ += count;
+            } else {
+                stats_.OnMove(size_ - p);
+                detail::InsertRangeInPlace(items_.GetAllocator(), items_.Get(), size_, p, count, first, last);
+                generation_.Bump();
+            }
+        } else {
+            // размер заранее неизвестен: дописываем в конец и переставляем на место одним поворотом
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(items_.Get() + p, items_.Get() + old_size, items_.Get() + size_);
+            stats_.OnCopy(size_ - old_size);
+            stats_.OnMove(size_ - p);
+            if (p != old_size) {
+                generation_.Bump();
+            }
+        }
+        return IteratorAt(p);
+    }
+
+    template <typename InputIt>
+    void Append(InputIt first, InputIt last) {
+        InsertRange(end(), first, last);
+    }
+
+    // Добавляет в конец count элементов, которые init(data, count) конструирует в свободной части блока
+    // после не более чем одного перераспределения. Вместимость растёт по политике роста, как у PushBack,
+    // поэтому повторные добавления дают амортизированное O(1) на элемент.
+    // Если init бросает исключение, она сама разрушает созданные ею элементы
+    template <typename Init>
+    void AppendUninitialized(size_t count, Init&& init) {
+        const size_t new_size = GrownSize(count);
+        if (new_size > GetCapacity()) {
+            Reallocate(NextCapacity(new_size));
+        }
+        init(items_.Get() + size_, count);
+        size_ += count;
     }
 
-    void PopBack() noexcept {
-        assert(size_ != 0);
+    // Заменяет содержимое копиями элементов [first, last), переиспользуя уже созданные элементы
+    template <typename InputIt>
+    void Assign(InputIt first, InputIt last) {
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            const size_t count = std::distance(first, last);
+            stats_.OnCopy(count);
+            if (count > GetCapacity()) {
+                ArrayPtr<Type, Allocator> tmp(count, items_.GetAllocator());
+                detail::UninitializedCopy(tmp.GetAllocator(), first, last, tmp.Get());
+                Clear();
+                items_.swap(tmp);
+                size_ = count;
+                CountAllocation();
+            } else {
+                detail::AssignInPlace(items_.GetAllocator(), items_.Get(), size_, count, first, last);
+                generation_.Bump();
+            }
+        } else {
+            Clear();
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    void PopBack() noexcept(!detail::kVectorChecksEnabled) {
+        if constexpr (detail::kVectorChecksEnabled) {
+            detail::Check(size_ != 0, "PopBack on an empty SimpleVector");
+        } else {
+            assert(size_ != 0);
+        }
         --size_;
+        detail::Destroy(items_.GetAllocator(), items_.Get() + size_);
     }
 
     Iterator Erase(ConstIterator pos) {
         assert(pos >= begin() && pos < end());
-        auto p = pos - begin();
-        std::copy(std::make_move_iterator(begin() + p + 1), std::make_move_iterator(end()), begin() + p);
-        --size_;
-        return begin() + p;
+        const size_t p = pos - begin();
+        stats_.OnMove(size_ - p - 1);
+        detail::EraseRange(items_.GetAllocator(), items_.Get(), size_, p, 1);
+        generation_.Bump();
+        return IteratorAt(p);
+    }
+
+    // Удаляет элементы [first, last), сдвигая хвост один раз
+    Iterator Erase(ConstIterator first, ConstIterator last) {
+        assert(begin() <= first && first <= last && last <= end());
+        const size_t p = first - begin();
+        const size_t count = last - first;
+        stats_.OnMove(size_ - p - count);
+        detail::EraseRange(items_.GetAllocator(), items_.Get(), size_, p, count);
+        if (count != 0) {
+            generation_.Bump();
+        }
+        return IteratorAt(p);
     }
 
+    // Аллокаторы обмениваются, только если это разрешает propagate_on_container_swap,
+    // иначе они должны быть равны
     void swap(SimpleVector& other) noexcept {
         items_.swap(other.items_);
         std::swap(size_, other.size_);
-        std::swap(capacity_, other.capacity_);
+        generation_.Bump();
+        other.generation_.Bump();
     }
 
     void Reserve(size_t new_capacity) {
-        if (new_capacity <= capacity_) {
+        if (new_capacity <= GetCapacity()) {
             return;
         }
 
-        ArrayPtr<Type> tmp(new_capacity);
-        std::copy(begin(), end(), &tmp[0]);
-        tmp.swap(items_);
-        capacity_ = new_capacity;
+        Reallocate(new_capacity);
     }
 
 private:
-    ArrayPtr<Type> items_;
+#ifdef SIMPLE_VECTOR_CHECKED
+    template <typename, typename>
+    friend class detail::CheckedIterator;
+#endif
+
+    // Элементы переносятся memcpy/memmove, а при поддержке аллокатором - его reallocate
+    static constexpr bool kRelocateBitwise = detail::kRelocateBitwise<Allocator, Type>;
+    static constexpr bool kUseReallocate = kRelocateBitwise && detail::HasReallocate<Allocator>::value;
+
+    ArrayPtr<Type, Allocator> items_;
 
     size_t size_ = 0;
-    size_t capacity_ = 0;
+
+    [[no_unique_address]] detail::StatsCounter stats_;
+
+    [[no_unique_address]] detail::IteratorGeneration generation_;
+
+    Iterator IteratorAt(size_t index) noexcept {
+#ifdef SIMPLE_VECTOR_CHECKED
+        return {this, index};
+#else
+        return items_.Get() + index;
+#endif
+    }
+
+    ConstIterator IteratorAt(size_t index) const noexcept {
+#ifdef SIMPLE_VECTOR_CHECKED
+        return {this, index};
+#else
+        return items_.Get() + index;
+#endif
+    }
+
+    void CheckIndex(size_t index) const noexcept(!detail::kVectorChecksEnabled) {
+        if constexpr (detail::kVectorChecksEnabled) {
+            detail::Check(index < size_, "SimpleVector index is out of range");
+        } else {
+            assert(index < size_);
+        }
+    }
+
+    // size_ + count; в проверяемом режиме с проверкой переполнения
+    size_t GrownSize(size_t count) const noexcept(!detail::kVectorChecksEnabled) {
+        return detail::AddSizes(size_, count, AllocTraits::max_size(items_.GetAllocator()));
+    }
+
+    // Учитывает в статистике только что полученный блок
+    void CountAllocation() noexcept {
+        if (GetCapacity() != 0) {
+            stats_.OnAllocate(GetCapacity(), GetCapacity() * sizeof(Type));
+        }
+    }
+
+    // Учитывает переезд size_ элементов из блока вместимостью old_capacity в новый
+    void CountReallocation(size_t old_capacity) noexcept {
+        CountAllocation();
+        if (old_capacity != 0) {
+            stats_.OnReallocate();
+            stats_.OnMove(size_);
+        }
+    }
+
+    size_t NextCapacity(size_t required) const noexcept(!detail::kVectorChecksEnabled) {
+        const size_t capacity = GrowthPolicy::NextCapacity(GetCapacity(), required, sizeof(Type));
+        if constexpr (detail::kVectorChecksEnabled) {
+            // политика могла переполниться, умножая вместимость: не больше max_size, но не меньше required
+            const size_t max_size = AllocTraits::max_size(items_.GetAllocator());
+            if (required > max_size) {
+                throw std::length_error("SimpleVector size exceeds the allocator's max_size");
+            }
+            detail::Check(capacity >= required, "growth policy returned a capacity below the required size");
+            return std::min(capacity, max_size);
+        }
+        return capacity;
+    }
+
+    // Меняет вместимость, не добавляя элементов
+    void Reallocate(size_t new_capacity) {
+        generation_.Bump();
+        if constexpr (kUseReallocate) {
+            const size_t old_capacity = GetCapacity();
+            items_.Reallocate(new_capacity);
+            CountReallocation(old_capacity);
+        } else {
+            ReallocateWithGap(new_capacity, size_, 0, [](Type*) {});
+        }
+    }
+
+    // Переносит элементы other в собственную память, когда забрать его память нельзя
+    void MoveElementsFrom(SimpleVector& other) {
+        ArrayPtr<Type, Allocator> tmp(other.size_, items_.GetAllocator());
+        detail::UninitializedCopy(tmp.GetAllocator(), std::make_move_iterator(other.Data()),
+                                  std::make_move_iterator(other.Data() + other.size_), tmp.Get());
+        items_.swap(tmp);
+        size_ = other.size_;
+        other.Clear();
+        CountAllocation();
+        stats_.OnMove(size_);
+    }
+
+    // Переезжает в новое хранилище, оставляя перед позицией index неинициализированный
+    // промежуток из gap_size элементов, который заполняет construct.
+    // Новые элементы конструируются до переноса старых, поэтому аргументы могут ссылаться на элементы вектора
+    template <typename Construct>
+    void ReallocateWithGap(size_t new_capacity, size_t index, size_t gap_size, Construct&& construct) {
+        Allocator& alloc = items_.GetAllocator();
+        ArrayPtr<Type, Allocator> tmp(new_capacity, alloc);
+        Type* const old_items = items_.Get();
+        Type* const new_items = tmp.Get();
+
+        construct(new_items + index);
+        detail::RelocateAroundGap(alloc, old_items, size_, new_items, index, gap_size);
+        items_.swap(tmp);
+        generation_.Bump();
+        CountReallocation(tmp.GetSize());
+    }
 };
 
-template <typename Type>
-inline bool operator==(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return lhs.GetSize() == rhs.GetSize() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+// Удаляет все элементы, удовлетворяющие pred, за один проход. Возвращает число удалённых элементов
+template <typename Type, typename Allocator, typename GrowthPolicy, typename Predicate>
+size_t EraseIf(SimpleVector<Type, Allocator, GrowthPolicy>& vector, Predicate pred) {
+    const auto new_end = std::remove_if(vector.begin(), vector.end(), pred);
+    const size_t removed = vector.end() - new_end;
+    vector.Erase(new_end, vector.end());
+    return removed;
 }
 
+// SimpleVector, берущий память из std::pmr::memory_resource
 template <typename Type>
-inline bool operator!=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+using PmrSimpleVector = SimpleVector<Type, std::pmr::polymorphic_allocator<Type>>;
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator==(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && detail::EqualRanges(lhs.Data(), rhs.Data(), lhs.GetSize());
+}
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator!=(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
     return !(lhs == rhs);
 }
 
-template <typename Type>
-inline bool operator<(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
-    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator<(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
+    return detail::LessRanges(lhs.Data(), lhs.GetSize(), rhs.Data(), rhs.GetSize());
 }
 
-template <typename Type>
-inline bool operator<=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator<=(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
     return !(rhs < lhs);
 }
 
-template <typename Type>
-inline bool operator>(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator>(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
     return rhs < lhs;
 }
 
-template <typename Type>
-inline bool operator>=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator, typename GrowthPolicy>
+inline bool operator>=(const SimpleVector<Type, Allocator, GrowthPolicy>& lhs, const SimpleVector<Type, Allocator, GrowthPolicy>& rhs) {
     return !(lhs < rhs);
 }
 
@@ -0,0 +1,495 @@
+#pragma once
+
+#include <cstdlib>
+#include <initializer_list>
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "array_ptr.h"
+#include "compare_ops.h"
+#include "growth_policy.h"
+#include "memory_utils.h"
+#include "simple_vector.h"
+#include "vector_ops.h"
+
+// Вектор с интерфейсом SimpleVector, хранящий до N элементов внутри себя.
+// К аллокатору обращается, только когда элементов становится больше N
+template <typename Type, size_t N, typename Allocator = std::allocator<Type>,
+          typename GrowthPolicy = DefaultGrowthPolicy>
+class SmallSimpleVector {
+    static_assert(N > 0, "use SimpleVector for vectors without inline storage");
+
+    using AllocTraits = std::allocator_traits<Allocator>;
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+    using AllocatorType = Allocator;
+    using GrowthPolicyType = GrowthPolicy;
+
+    static constexpr size_t kInlineCapacity = N;
+
+    SmallSimpleVector() noexcept(noexcept(Allocator())) = default;
+
+    explicit SmallSimpleVector(const Allocator& alloc) noexcept
+            : alloc_(alloc)
+    {
+    }
+
+    explicit SmallSimpleVector(size_t size, const Allocator& alloc = Allocator())
+            : SmallSimpleVector(alloc)
+    {
+        Resize(size);
+    }
+
+    SmallSimpleVector(size_t size, const Type& value, const Allocator& alloc = Allocator())
+            : SmallSimpleVector(alloc)
+    {
+        Reserve(size);
+        detail::UninitializedFillN(alloc_, data_, size, value);
+        size_ = size;
+    }
+
+    SmallSimpleVector(std::initializer_list<Type> init, const Allocator& alloc = Allocator())
+            : SmallSimpleVector(alloc)
+    {
+        Append(init.begin(), init.end());
+    }
+
+    SmallSimpleVector(const SmallSimpleVector& other)
+            : SmallSimpleVector(AllocTraits::select_on_container_copy_construction(other.alloc_))
+    {
+        Append(other.begin(), other.end());
+    }
+
+    SmallSimpleVector& operator=(const SmallSimpleVector& rhs) {
+        if (this == &rhs) {
+            return *this;
+        }
+
+        if constexpr (AllocTraits::propagate_on_container_copy_assignment::value) {
+            if (alloc_ != rhs.alloc_) {
+                Clear();
+                FreeHeap();
+                alloc_ = rhs.alloc_;
+            }
+        }
+        Assign(rhs.begin(), rhs.end());
+        return *this;
+    }
+
+    // Память в куче забирается целиком, встроенные элементы переносятся поштучно
+    SmallSimpleVector(SmallSimpleVector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>)
+            : alloc_(std::move(other.alloc_))
+    {
+        if (other.IsInline()) {
+            detail::UninitializedCopy(alloc_, std::make_move_iterator(other.begin()),
+                                      std::make_move_iterator(other.end()), data_);
+            size_ = other.size_;
+            other.Clear();
+        } else {
+            StealHeap(other);
+        }
+    }
+
+    SmallSimpleVector& operator=(SmallSimpleVector&& rhs) noexcept(
+            std::is_nothrow_move_constructible_v<Type> &&
+            (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value)) {
+        if (this == &rhs) {
+            return *this;
+        }
+
+        Clear();
+        if (!rhs.IsInline() && CanStealFrom(rhs)) {
+            FreeHeap();
+            if constexpr (AllocTraits::propagate_on_container_move_assignment::value) {
+                alloc_ = std::move(rhs.alloc_);
+            }
+            StealHeap(rhs);
+            return *this;
+        }
+
+        Reserve(rhs.size_);
+        detail::UninitializedCopy(alloc_, std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()),
+                                  data_);
+        size_ = rhs.size_;
+        rhs.Clear();
+        return *this;
+    }
+
+    SmallSimpleVector(const ReserveProxyObj& obj, const Allocator& alloc = Allocator())
+            : SmallSimpleVector(alloc)
+    {
+        Reserve(obj.GetCapacity());
+    }
+
+    ~SmallSimpleVector() {
+        Clear();
+        FreeHeap();
+    }
+
+    Allocator GetAllocator() const noexcept {
+        return alloc_;
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Элементы лежат во встроенном буфере, а не в куче
+    bool IsInline() const noexcept {
+        return data_ == InlineData();
+    }
+
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return data_[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return data_[index];
+    }
+
+    void Clear() noexcept {
+        detail::DestroyN(alloc_, data_, size_);
+        size_ = 0;
+    }
+
+    // Очищает вектор; при release_memory == true ещё и возвращает память кучи аллокатору
+    void Clear(bool release_memory) noexcept {
+        Clear();
+        if (release_memory) {
+            FreeHeap();
+        }
+    }
+
+    // Возвращает элементы во встроенный буфер, если они там помещаются, иначе ужимает блок в куче
+    void ShrinkToFit() {
+        if (IsInline() || size_ == capacity_) {
+            return;
+        }
+        if (size_ <= N) {
+            detail::RelocateAroundGap(alloc_, data_, size_, InlineData(), size_, 0);
+            Type* const heap = data_;
+            data_ = InlineData();
+            ArrayPtr<Type, Allocator> old(heap, std::exchange(capacity_, N), alloc_);
+            return;
+        }
+        ReallocateWithGap(size_, size_, 0, [](Type*) {});
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size <= size_) {
+            detail::DestroyN(alloc_, data_ + new_size, size_ - new_size);
+            size_ = new_size;
+            return;
+        }
+
+        const size_t count = new_size - size_;
+        if (new_size <= capacity_) {
+            detail::UninitializedValueConstructN(alloc_, data_ + size_, count);
+        } else {
+            ReallocateWithGap(NextCapacity(new_size), size_, count, [this, count](Type* gap) {
+                detail::UninitializedValueConstructN(alloc_, gap, count);
+            });
+        }
+        size_ = new_size;
+    }
+
+    Iterator begin() noexcept {
+        return data_;
+    }
+
+    Iterator end() noexcept {
+        return data_ + size_;
+    }
+
+    ConstIterator begin() const noexcept {
+        return data_;
+    }
+
+    ConstIterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    // Конструирует элемент прямо в конце вектора, аргументы могут ссылаться на его элементы
+    template <typename... Args>
+    Type& EmplaceBack(Args&&... args) {
+        if (size_ != capacity_) {
+            detail::Construct(alloc_, data_ + size_, std::forward<Args>(args)...);
+        } else {
+            ReallocateWithGap(NextCapacity(size_ + 1), size_, 1, [&](Type* gap) {
+                detail::Construct(alloc_, gap, std::forward<Args>(args)...);
+            });
+        }
+        return data_[size_++];
+    }
+
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    Iterator Emplace(ConstIterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end());
+        const size_t p = pos - begin();
+
+        if (p == size_) {
+            EmplaceBack(std::forward<Args>(args)...);
+        } else if (size_ != capacity_) {
+            // временный объект нужен до сдвига: аргументы могут ссылаться на сдвигаемые элементы
+            Type value(std::forward<Args>(args)...);
+            detail::InsertInPlace(alloc_, data_, size_, p, std::move(value));
+        } else {
+            ReallocateWithGap(NextCapacity(size_ + 1), p, 1, [&](Type* gap) {
+                detail::Construct(alloc_, gap, std::forward<Args>(args)...);
+            });
+            ++size_;
+        }
+        return begin() + p;
+    }
+
+    // Диапазон не должен указывать на элементы самого вектора
+    template <typename InputIt>
+    Iterator InsertRange(ConstIterator pos, InputIt first, InputIt last) {
+        assert(pos >= begin() && pos <= end());
+        const size_t p = pos - begin();
+
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            const size_t count = std::distance(first, last);
+            if (size_ + count > capacity_) {
+                ReallocateWithGap(NextCapacity(size_ + count), p, count, [&](Type* gap) {
+                    detail::UninitializedCopy(alloc_, first, last, gap);
+                });
+                size_ += count;
+            } else if (count != 0) {
+                detail::InsertRangeInPlace(alloc_, data_, size_, p, count, first, last);
+            }
+        } else {
+            const size_t old_size = size_;
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+            std::rotate(begin() + p, begin() + old_size, end());
+        }
+        return begin() + p;
+    }
+
+    template <typename InputIt>
+    void Append(InputIt first, InputIt last) {
+        InsertRange(end(), first, last);
+    }
+
+    template <typename InputIt>
+    void Assign(InputIt first, InputIt last) {
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            const size_t count = std::distance(first, last);
+            if (count > capacity_) {
+                Clear();
+                ReallocateWithGap(count, 0, count, [&](Type* gap) {
+                    detail::UninitializedCopy(alloc_, first, last, gap);
+                });
+                size_ = count;
+            } else {
+                detail::AssignInPlace(alloc_, data_, size_, count, first, last);
+            }
+        } else {
+            Clear();
+            for (; first != last; ++first) {
+                EmplaceBack(*first);
+            }
+        }
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        detail::Destroy(alloc_, data_ + size_);
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        assert(pos >= begin() && pos < end());
+        const size_t p = pos - begin();
+        detail::EraseRange(alloc_, data_, size_, p, 1);
+        return begin() + p;
+    }
+
+    Iterator Erase(ConstIterator first, ConstIterator last) {
+        assert(begin() <= first && first <= last && last <= end());
+        const size_t p = first - begin();
+        detail::EraseRange(alloc_, data_, size_, p, static_cast<size_t>(last - first));
+        return begin() + p;
+    }
+
+    // Если хотя бы один из векторов хранит элементы во встроенном буфере, они переносятся поштучно
+    void swap(SmallSimpleVector& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        if (!IsInline() && !other.IsInline()) {
+            if constexpr (AllocTraits::propagate_on_container_swap::value) {
+                using std::swap;
+                swap(alloc_, other.alloc_);
+            }
+            std::swap(data_, other.data_);
+            std::swap(size_, other.size_);
+            std::swap(capacity_, other.capacity_);
+            return;
+        }
+        SmallSimpleVector tmp(std::move(other));
+        other = std::move(*this);
+        *this = std::move(tmp);
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity <= capacity_) {
+            return;
+        }
+
+        ReallocateWithGap(new_capacity, size_, 0, [](Type*) {});
+    }
+
+private:
+    Type* data_ = InlineData();
+    size_t size_ = 0;
+    size_t capacity_ = N;
+    [[no_unique_address]] Allocator alloc_;
+    alignas(Type) unsigned char buffer_[N * sizeof(Type)];
+
+    Type* InlineData() noexcept {
+        return reinterpret_cast<Type*>(buffer_);
+    }
+
+    const Type* InlineData() const noexcept {
+        return reinterpret_cast<const Type*>(buffer_);
+    }
+
+    size_t NextCapacity(size_t required) const noexcept {
+        return GrowthPolicy::NextCapacity(capacity_, required, sizeof(Type));
+    }
+
+    bool CanStealFrom(const SmallSimpleVector& other) const noexcept {
+        if constexpr (AllocTraits::propagate_on_container_move_assignment::value || AllocTraits::is_always_equal::value) {
+            return true;
+        } else {
+            return alloc_ == other.alloc_;
+        }
+    }
+
+    // Забирает блок из кучи у other, у которого элементы уже не встроены
+    void StealHeap(SmallSimpleVector& other) noexcept {
+        data_ = std::exchange(other.data_, other.InlineData());
+        size_ = std::exchange(other.size_, 0);
+        capacity_ = std::exchange(other.capacity_, N);
+    }
+
+    // Освобождает блок в куче (элементы должны быть уже разрушены или перенесены) и возвращается к буферу
+    void FreeHeap() noexcept {
+        if (!IsInline()) {
+            ArrayPtr<Type, Allocator> old(data_, capacity_, alloc_);
+            data_ = InlineData();
+            capacity_ = N;
+        }
+    }
+
+    // Переезжает в новый блок в куче, оставляя перед позицией index промежуток из gap_size
+    // элементов, который заполняет construct. Новые элементы конструируются до переноса старых
+    template <typename Construct>
+    void ReallocateWithGap(size_t new_capacity, size_t index, size_t gap_size, Construct&& construct) {
+        ArrayPtr<Type, Allocator> tmp(new_capacity, alloc_);
+        construct(tmp.Get() + index);
+        detail::RelocateAroundGap(alloc_, data_, size_, tmp.Get(), index, gap_size);
+        FreeHeap();
+        capacity_ = tmp.GetSize();
+        data_ = tmp.Release();
+    }
+};
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator==(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                       const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && detail::EqualRanges(lhs.begin(), rhs.begin(), lhs.GetSize());
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator!=(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                       const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator<(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                      const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return detail::LessRanges(lhs.begin(), lhs.GetSize(), rhs.begin(), rhs.GetSize());
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator<=(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                       const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator>(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                      const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy>
+inline bool operator>=(const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& lhs,
+                       const SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& rhs) {
+    return !(lhs < rhs);
+}
+
+template <typename Type, size_t N, typename Allocator, typename GrowthPolicy, typename Predicate>
+size_t EraseIf(SmallSimpleVector<Type, N, Allocator, GrowthPolicy>& vector, Predicate pred) {
+    const auto new_end = std::remove_if(vector.begin(), vector.end(), pred);
+    const size_t removed = vector.end() - new_end;
+    vector.Erase(new_end, vector.end());
+    return removed;
+}
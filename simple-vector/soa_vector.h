@@ -0,0 +1,461 @@
+#pragma once
+
+#include <cstdlib>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <memory>
+#include <span>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+#include "array_ptr.h"
+#include "compare_ops.h"
+#include "growth_policy.h"
+#include "memory_utils.h"
+
+// Вектор записей из полей Fields..., хранящий каждое поле в отдельном массиве (structure of arrays).
+// Все столбцы имеют общие размер и вместимость. Обход одного столбца через Column<I>() читает
+// непрерывную память и векторизуется, а строка доступна как кортеж ссылок на свои поля
+template <typename... Fields>
+class SoAVector {
+    static_assert(sizeof...(Fields) > 0, "SoAVector needs at least one field");
+
+    template <bool Const>
+    class BasicIterator;
+
+public:
+    using ValueType = std::tuple<Fields...>;
+    using Reference = std::tuple<Fields&...>;
+    using ConstReference = std::tuple<const Fields&...>;
+    using Iterator = BasicIterator<false>;
+    using ConstIterator = BasicIterator<true>;
+
+    template <size_t I>
+    using FieldType = std::tuple_element_t<I, ValueType>;
+
+    static constexpr size_t kFieldCount = sizeof...(Fields);
+
+    SoAVector() noexcept = default;
+
+    SoAVector(std::initializer_list<ValueType> init) {
+        Reserve(init.size());
+        for (const ValueType& row : init) {
+            PushBack(row);
+        }
+    }
+
+    SoAVector(const SoAVector& other) {
+        Reserve(other.size_);
+        // при исключении в столбце разрушаются уже скопированные столбцы
+        size_t copied = 0;
+        try {
+            ForEachField([&](auto field) {
+                constexpr size_t I = decltype(field)::value;
+                detail::UninitializedCopy(std::get<I>(columns_).GetAllocator(), other.template ColumnData<I>(),
+                                          other.template ColumnData<I>() + other.size_, ColumnData<I>());
+                ++copied;
+            });
+        } catch (...) {
+            DestroyRows(0, other.size_, copied);
+            throw;
+        }
+        size_ = other.size_;
+    }
+
+    SoAVector& operator=(const SoAVector& rhs) {
+        if (this != &rhs) {
+            SoAVector tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    SoAVector(SoAVector&& other) noexcept
+            : columns_(std::move(other.columns_))
+            , size_(std::exchange(other.size_, 0))
+    {
+    }
+
+    SoAVector& operator=(SoAVector&& rhs) noexcept {
+        if (this != &rhs) {
+            Clear();
+            columns_ = std::move(rhs.columns_);
+            size_ = std::exchange(rhs.size_, 0);
+        }
+        return *this;
+    }
+
+    ~SoAVector() {
+        Clear();
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    size_t GetCapacity() const noexcept {
+        return std::get<0>(columns_).GetSize();
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    Reference operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Row<Reference>(*this, index);
+    }
+
+    ConstReference operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Row<ConstReference>(*this, index);
+    }
+
+    Reference At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return (*this)[index];
+    }
+
+    ConstReference At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return (*this)[index];
+    }
+
+    // Поле I строки index
+    template <size_t I>
+    FieldType<I>& Get(size_t index) noexcept {
+        assert(index < size_);
+        return ColumnData<I>()[index];
+    }
+
+    template <size_t I>
+    const FieldType<I>& Get(size_t index) const noexcept {
+        assert(index < size_);
+        return ColumnData<I>()[index];
+    }
+
+    // Все значения поля I подряд; span действителен до изменения вместимости
+    template <size_t I>
+    std::span<FieldType<I>> Column() noexcept {
+        return {ColumnData<I>(), size_};
+    }
+
+    template <size_t I>
+    std::span<const FieldType<I>> Column() const noexcept {
+        return {ColumnData<I>(), size_};
+    }
+
+    void Clear() noexcept {
+        DestroyRows(0, size_, kFieldCount);
+        size_ = 0;
+    }
+
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > GetCapacity()) {
+            Reallocate(new_capacity);
+        }
+    }
+
+    void PushBack(const ValueType& row) {
+        std::apply([this](const Fields&... fields) {
+            EmplaceBack(fields...);
+        }, row);
+    }
+
+    void PushBack(ValueType&& row) {
+        std::apply([this](Fields&... fields) {
+            EmplaceBack(std::move(fields)...);
+        }, row);
+    }
+
+    // Принимает по одному аргументу конструктора на каждое поле
+    template <typename... Args>
+    Reference EmplaceBack(Args&&... args) {
+        static_assert(sizeof...(Args) == kFieldCount, "EmplaceBack needs one argument per field");
+        if (size_ == GetCapacity()) {
+            // аргументы могут ссылаться на элементы, которые переедут при перевыделении
+            ValueType row(std::forward<Args>(args)...);
+            Reallocate(GrowthPolicy::NextCapacity(GetCapacity(), size_ + 1, kRowSize));
+            std::apply([this](Fields&... fields) {
+                ConstructRow(size_, std::move(fields)...);
+            }, row);
+        } else {
+            ConstructRow(size_, std::forward<Args>(args)...);
+        }
+        ++size_;
+        return (*this)[size_ - 1];
+    }
+
+    void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        DestroyRows(size_, size_ + 1, kFieldCount);
+    }
+
+    Iterator begin() noexcept {
+        return {this, 0};
+    }
+
+    Iterator end() noexcept {
+        return {this, size_};
+    }
+
+    ConstIterator begin() const noexcept {
+        return {this, 0};
+    }
+
+    ConstIterator end() const noexcept {
+        return {this, size_};
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    void swap(SoAVector& other) noexcept {
+        ForEachField([&](auto field) {
+            std::get<decltype(field)::value>(columns_).swap(std::get<decltype(field)::value>(other.columns_));
+        });
+        std::swap(size_, other.size_);
+    }
+
+private:
+    using GrowthPolicy = DefaultGrowthPolicy;
+
+    static constexpr size_t kRowSize = (sizeof(Fields) + ...);
+
+    template <typename Field>
+    static constexpr bool kRelocateBitwise = detail::kRelocateBitwise<std::allocator<Field>, Field>;
+
+    // Столбцы, перенос которых не бросает исключений, переносятся после остальных
+    template <typename Field>
+    static constexpr bool kNothrowRelocate = kRelocateBitwise<Field> || std::is_nothrow_move_constructible_v<Field>;
+
+    std::tuple<ArrayPtr<Fields>...> columns_;
+    size_t size_ = 0;
+
+    template <typename Func>
+    static void ForEachField(Func&& func) {
+        [&]<size_t... I>(std::index_sequence<I...>) {
+            (func(std::integral_constant<size_t, I>{}), ...);
+        }(std::index_sequence_for<Fields...>{});
+    }
+
+    template <typename RowReference, typename Self>
+    static RowReference Row(Self& self, size_t index) noexcept {
+        return [&]<size_t... I>(std::index_sequence<I...>) {
+            return RowReference(self.template ColumnData<I>()[index]...);
+        }(std::index_sequence_for<Fields...>{});
+    }
+
+    template <size_t I>
+    FieldType<I>* ColumnData() noexcept {
+        return std::get<I>(columns_).Get();
+    }
+
+    template <size_t I>
+    const FieldType<I>* ColumnData() const noexcept {
+        return std::get<I>(columns_).Get();
+    }
+
+    // Разрушает строки [first, last) в первых field_count столбцах
+    void DestroyRows(size_t first, size_t last, size_t field_count) noexcept {
+        ForEachField([&](auto field) {
+            constexpr size_t I = decltype(field)::value;
+            if (I < field_count) {
+                auto& column = std::get<I>(columns_);
+                detail::DestroyN(column.GetAllocator(), column.Get() + first, last - first);
+            }
+        });
+    }
+
+    // Конструирует поля строки index; если поле бросает исключение, уже созданные поля разрушаются
+    template <typename... Args>
+    void ConstructRow(size_t index, Args&&... args) {
+        size_t constructed = 0;
+        try {
+            [&]<size_t... I>(std::index_sequence<I...>) {
+                ((detail::Construct(std::get<I>(columns_).GetAllocator(), ColumnData<I>() + index,
+                                    std::forward<Args>(args)),
+                  ++constructed),
+                 ...);
+            }(std::index_sequence_for<Fields...>{});
+        } catch (...) {
+            DestroyRows(index, index + 1, constructed);
+            throw;
+        }
+    }
+
+    // Сначала переносятся столбцы, которые могут бросить исключение: если это случится, ни один
+    // исходный элемент ещё не перемещён, и разрушить нужно только созданные копии
+    void Reallocate(size_t new_capacity) {
+        std::tuple<ArrayPtr<Fields>...> fresh{ArrayPtr<Fields>(new_capacity)...};
+        bool relocated[kFieldCount] = {};
+        try {
+            ForEachField([&](auto field) {
+                RelocateColumn<decltype(field)::value, false>(fresh, relocated);
+            });
+        } catch (...) {
+            ForEachField([&](auto field) {
+                constexpr size_t I = decltype(field)::value;
+                if (relocated[I]) {
+                    auto& column = std::get<I>(fresh);
+                    detail::DestroyN(column.GetAllocator(), column.Get(), size_);
+                }
+            });
+            throw;
+        }
+        ForEachField([&](auto field) {
+            RelocateColumn<decltype(field)::value, true>(fresh, relocated);
+        });
+
+        // побайтно перенесённые элементы не разрушаются: они уже живут в новом блоке
+        ForEachField([&](auto field) {
+            constexpr size_t I = decltype(field)::value;
+            if constexpr (!kRelocateBitwise<FieldType<I>>) {
+                auto& column = std::get<I>(columns_);
+                detail::DestroyN(column.GetAllocator(), column.Get(), size_);
+            }
+        });
+        columns_.swap(fresh);
+    }
+
+    template <size_t I, bool Nothrow>
+    void RelocateColumn(std::tuple<ArrayPtr<Fields>...>& fresh, bool* relocated) {
+        using Field = FieldType<I>;
+        if constexpr (kNothrowRelocate<Field> == Nothrow) {
+            auto& from = std::get<I>(columns_);
+            auto& to = std::get<I>(fresh);
+            if constexpr (kRelocateBitwise<Field>) {
+                detail::RelocateBitwise(from.Get(), size_, to.Get());
+            } else {
+                detail::UninitializedRelocateN(to.GetAllocator(), from.Get(), size_, to.Get());
+            }
+            relocated[I] = true;
+        }
+    }
+
+    // Итератор по строкам; разыменование даёт кортеж ссылок, поэтому это итератор с прокси-ссылками:
+    // для C++20 он произвольного доступа, а для старых алгоритмов - итератор ввода
+    template <bool Const>
+    class BasicIterator {
+        using Owner = std::conditional_t<Const, const SoAVector, SoAVector>;
+
+    public:
+        using iterator_concept = std::random_access_iterator_tag;
+        using iterator_category = std::input_iterator_tag;
+        using value_type = ValueType;
+        using difference_type = std::ptrdiff_t;
+        using reference = std::conditional_t<Const, ConstReference, Reference>;
+        using pointer = void;
+
+        BasicIterator() noexcept = default;
+
+        BasicIterator(Owner* owner, size_t index) noexcept
+                : owner_(owner)
+                , index_(index)
+        {
+        }
+
+        operator BasicIterator<true>() const noexcept requires(!Const) {
+            return {owner_, index_};
+        }
+
+        reference operator*() const noexcept {
+            return (*owner_)[index_];
+        }
+
+        reference operator[](difference_type n) const noexcept {
+            return (*owner_)[index_ + n];
+        }
+
+        BasicIterator& operator++() noexcept {
+            ++index_;
+            return *this;
+        }
+
+        BasicIterator operator++(int) noexcept {
+            BasicIterator old = *this;
+            ++index_;
+            return old;
+        }
+
+        BasicIterator& operator--() noexcept {
+            --index_;
+            return *this;
+        }
+
+        BasicIterator operator--(int) noexcept {
+            BasicIterator old = *this;
+            --index_;
+            return old;
+        }
+
+        BasicIterator& operator+=(difference_type n) noexcept {
+            index_ += n;
+            return *this;
+        }
+
+        BasicIterator& operator-=(difference_type n) noexcept {
+            index_ -= n;
+            return *this;
+        }
+
+        friend BasicIterator operator+(BasicIterator it, difference_type n) noexcept {
+            return it += n;
+        }
+
+        friend BasicIterator operator+(difference_type n, BasicIterator it) noexcept {
+            return it += n;
+        }
+
+        friend BasicIterator operator-(BasicIterator it, difference_type n) noexcept {
+            return it -= n;
+        }
+
+        friend difference_type operator-(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+        }
+
+        friend bool operator==(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ == rhs.index_;
+        }
+
+        friend auto operator<=>(const BasicIterator& lhs, const BasicIterator& rhs) noexcept {
+            return lhs.index_ <=> rhs.index_;
+        }
+
+    private:
+        Owner* owner_ = nullptr;
+        size_t index_ = 0;
+    };
+};
+
+template <typename... Fields>
+bool operator==(const SoAVector<Fields...>& lhs, const SoAVector<Fields...>& rhs) {
+    if (lhs.GetSize() != rhs.GetSize()) {
+        return false;
+    }
+    return [&]<size_t... I>(std::index_sequence<I...>) {
+        return (detail::EqualRanges(lhs.template Column<I>().data(), rhs.template Column<I>().data(), lhs.GetSize()) &&
+                ...);
+    }(std::index_sequence_for<Fields...>{});
+}
+
+template <typename... Fields>
+bool operator!=(const SoAVector<Fields...>& lhs, const SoAVector<Fields...>& rhs) {
+    return !(lhs == rhs);
+}
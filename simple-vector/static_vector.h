@@ -0,0 +1,367 @@
+#pragma once
+
+#include <cstdlib>
+#include <initializer_list>
+#include <stdexcept>
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "vector_ops.h"
+
+// Вектор с интерфейсом SimpleVector и вместимостью N, заданной при компиляции.
+// Никогда не выделяет память: элементы лежат внутри объекта. Переполнение PushBack/Insert/Resize
+// сообщается исключением std::length_error, а Try-методы сообщают о нём результатом без исключений.
+// Все методы constexpr и работают при компиляции, если это позволяет Type
+template <typename Type, size_t N>
+class StaticVector {
+    static_assert(N > 0, "StaticVector needs a positive capacity");
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    constexpr StaticVector() noexcept {
+    }
+
+    constexpr explicit StaticVector(size_t size) {
+        Resize(size);
+    }
+
+    constexpr StaticVector(size_t size, const Type& value) {
+        CheckCapacity(size);
+        for (; size_ < size; ++size_) {
+            std::construct_at(Data() + size_, value);
+        }
+    }
+
+    constexpr StaticVector(std::initializer_list<Type> init) {
+        Append(init.begin(), init.end());
+    }
+
+    constexpr StaticVector(const StaticVector& other) {
+        Append(other.begin(), other.end());
+    }
+
+    constexpr StaticVector& operator=(const StaticVector& rhs) {
+        if (this != &rhs) {
+            Assign(rhs.begin(), rhs.end());
+        }
+        return *this;
+    }
+
+    constexpr StaticVector(StaticVector&& other) noexcept(std::is_nothrow_move_constructible_v<Type>) {
+        Append(std::make_move_iterator(other.begin()), std::make_move_iterator(other.end()));
+        other.Clear();
+    }
+
+    constexpr StaticVector& operator=(StaticVector&& rhs) noexcept(std::is_nothrow_move_constructible_v<Type> &&
+                                                                   std::is_nothrow_move_assignable_v<Type>) {
+        if (this != &rhs) {
+            Assign(std::make_move_iterator(rhs.begin()), std::make_move_iterator(rhs.end()));
+            rhs.Clear();
+        }
+        return *this;
+    }
+
+    constexpr ~StaticVector() {
+        Clear();
+    }
+
+    constexpr size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    static constexpr size_t GetCapacity() noexcept {
+        return N;
+    }
+
+    constexpr bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    constexpr bool IsFull() const noexcept {
+        return size_ == N;
+    }
+
+    constexpr Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    constexpr const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return Data()[index];
+    }
+
+    constexpr Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return Data()[index];
+    }
+
+    constexpr const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("Method At(index): index >= size");
+        }
+        return Data()[index];
+    }
+
+    constexpr void Clear() noexcept {
+        std::destroy_n(Data(), size_);
+        size_ = 0;
+    }
+
+    constexpr void Resize(size_t new_size) {
+        CheckCapacity(new_size);
+        for (; size_ > new_size; --size_) {
+            std::destroy_at(Data() + size_ - 1);
+        }
+        for (; size_ < new_size; ++size_) {
+            std::construct_at(Data() + size_);
+        }
+    }
+
+    // Вместимость постоянна: запрос больше N - ошибка
+    constexpr void Reserve(size_t new_capacity) const {
+        CheckCapacity(new_capacity);
+    }
+
+    constexpr Iterator begin() noexcept {
+        return Data();
+    }
+
+    constexpr Iterator end() noexcept {
+        return Data() + size_;
+    }
+
+    constexpr ConstIterator begin() const noexcept {
+        return Data();
+    }
+
+    constexpr ConstIterator end() const noexcept {
+        return Data() + size_;
+    }
+
+    constexpr ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    constexpr ConstIterator cend() const noexcept {
+        return end();
+    }
+
+    constexpr void PushBack(const Type& item) {
+        EmplaceBack(item);
+    }
+
+    constexpr void PushBack(Type&& item) {
+        EmplaceBack(std::move(item));
+    }
+
+    template <typename... Args>
+    constexpr Type& EmplaceBack(Args&&... args) {
+        CheckCapacity(size_ + 1);
+        return *TryEmplaceBack(std::forward<Args>(args)...);
+    }
+
+    // Возвращает false, если вектор заполнен
+    constexpr bool TryPushBack(const Type& item) {
+        return TryEmplaceBack(item) != nullptr;
+    }
+
+    constexpr bool TryPushBack(Type&& item) {
+        return TryEmplaceBack(std::move(item)) != nullptr;
+    }
+
+    // Возвращает указатель на созданный элемент или nullptr, если вектор заполнен
+    template <typename... Args>
+    constexpr Type* TryEmplaceBack(Args&&... args) {
+        if (size_ == N) {
+            return nullptr;
+        }
+        Type* const slot = std::construct_at(Data() + size_, std::forward<Args>(args)...);
+        ++size_;
+        return slot;
+    }
+
+    constexpr Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos, value);
+    }
+
+    constexpr Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos, std::move(value));
+    }
+
+    template <typename... Args>
+    constexpr Iterator Emplace(ConstIterator pos, Args&&... args) {
+        CheckCapacity(size_ + 1);
+        return TryEmplace(pos, std::forward<Args>(args)...);
+    }
+
+    // Возвращает итератор на вставленный элемент или end(), если вектор заполнен
+    template <typename... Args>
+    constexpr Iterator TryEmplace(ConstIterator pos, Args&&... args) {
+        assert(pos >= begin() && pos <= end());
+        const size_t p = pos - begin();
+        if (size_ == N) {
+            return end();
+        }
+        if (p == size_) {
+            TryEmplaceBack(std::forward<Args>(args)...);
+            return begin() + p;
+        }
+
+        // временный объект нужен до сдвига: аргументы могут ссылаться на сдвигаемые элементы
+        Type value(std::forward<Args>(args)...);
+        std::construct_at(Data() + size_, std::move(Data()[size_ - 1]));
+        ++size_;
+        std::move_backward(Data() + p, Data() + size_ - 2, Data() + size_ - 1);
+        Data()[p] = std::move(value);
+        return begin() + p;
+    }
+
+    // Диапазон не должен указывать на элементы самого вектора
+    template <typename InputIt>
+    constexpr Iterator InsertRange(ConstIterator pos, InputIt first, InputIt last) {
+        assert(pos >= begin() && pos <= end());
+        const size_t p = pos - begin();
+        const size_t old_size = size_;
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            CheckCapacity(size_ + std::distance(first, last));
+        }
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+        std::rotate(begin() + p, begin() + old_size, end());
+        return begin() + p;
+    }
+
+    template <typename InputIt>
+    constexpr void Append(InputIt first, InputIt last) {
+        InsertRange(end(), first, last);
+    }
+
+    template <typename InputIt>
+    constexpr void Assign(InputIt first, InputIt last) {
+        if constexpr (detail::kIsForwardIterator<InputIt>) {
+            CheckCapacity(std::distance(first, last));
+        }
+        size_t i = 0;
+        for (; i < size_ && first != last; ++i, ++first) {
+            Data()[i] = *first;
+        }
+        for (; size_ > i; --size_) {
+            std::destroy_at(Data() + size_ - 1);
+        }
+        for (; first != last; ++first) {
+            EmplaceBack(*first);
+        }
+    }
+
+    constexpr void PopBack() noexcept {
+        assert(size_ != 0);
+        --size_;
+        std::destroy_at(Data() + size_);
+    }
+
+    constexpr Iterator Erase(ConstIterator pos) {
+        assert(pos >= begin() && pos < end());
+        return Erase(pos, pos + 1);
+    }
+
+    constexpr Iterator Erase(ConstIterator first, ConstIterator last) {
+        assert(begin() <= first && first <= last && last <= end());
+        const size_t p = first - begin();
+        const size_t count = last - first;
+        std::move(Data() + p + count, end(), Data() + p);
+        for (size_t i = 0; i < count; ++i) {
+            PopBack();
+        }
+        return begin() + p;
+    }
+
+    constexpr void swap(StaticVector& other) noexcept(std::is_nothrow_swappable_v<Type> &&
+                                                      std::is_nothrow_move_constructible_v<Type>) {
+        StaticVector& shorter = size_ < other.size_ ? *this : other;
+        StaticVector& longer = size_ < other.size_ ? other : *this;
+        const size_t common = shorter.size_;
+        std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+        for (size_t i = common; i < longer.size_; ++i) {
+            shorter.EmplaceBack(std::move(longer.Data()[i]));
+        }
+        while (longer.size_ > common) {
+            longer.PopBack();
+        }
+    }
+
+private:
+    // Объединение позволяет не конструировать элементы заранее и остаётся пригодным для constexpr
+    union Storage {
+        constexpr Storage() noexcept {
+        }
+        constexpr ~Storage() {
+        }
+
+        Type items[N];
+    };
+
+    Storage storage_;
+    size_t size_ = 0;
+
+    constexpr Type* Data() noexcept {
+        return storage_.items;
+    }
+
+    constexpr const Type* Data() const noexcept {
+        return storage_.items;
+    }
+
+    static constexpr void CheckCapacity(size_t required) {
+        if (required > N) {
+            throw std::length_error("StaticVector capacity exceeded");
+        }
+    }
+};
+
+template <typename Type, size_t N>
+constexpr bool operator==(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return lhs.GetSize() == rhs.GetSize() && std::equal(lhs.begin(), lhs.end(), rhs.begin());
+}
+
+template <typename Type, size_t N>
+constexpr bool operator!=(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type, size_t N>
+constexpr bool operator<(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type, size_t N>
+constexpr bool operator<=(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type, size_t N>
+constexpr bool operator>(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type, size_t N>
+constexpr bool operator>=(const StaticVector<Type, N>& lhs, const StaticVector<Type, N>& rhs) {
+    return !(lhs < rhs);
+}
+
+template <typename Type, size_t N, typename Predicate>
+constexpr size_t EraseIf(StaticVector<Type, N>& vector, Predicate pred) {
+    const auto new_end = std::remove_if(vector.begin(), vector.end(), pred);
+    const size_t removed = vector.end() - new_end;
+    vector.Erase(new_end, vector.end());
+    return removed;
+}
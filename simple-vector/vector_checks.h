@@ -0,0 +1,211 @@
+#pragma once
+
+#include <compare>
+#include <cstdlib>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+
+// Проверяемый режим SimpleVector. Включается, если до подключения simple_vector.h определён макрос
+// SIMPLE_VECTOR_CHECKED (одинаково во всех единицах трансляции). В нём итераторы помнят свой вектор
+// и поколение его хранилища и проверяют каждое обращение, operator[] и PopBack проверяют границы
+// и при NDEBUG, а рост проверяет переполнение размеров. Без макроса итераторы - обычные указатели,
+// и проверки ничего не стоят
+
+// Обращение через недействительный итератор или за границы вектора в проверяемом режиме
+class CheckedAccessError : public std::logic_error {
+public:
+    using std::logic_error::logic_error;
+};
+
+namespace detail {
+
+#ifdef SIMPLE_VECTOR_CHECKED
+inline constexpr bool kVectorChecksEnabled = true;
+#else
+inline constexpr bool kVectorChecksEnabled = false;
+#endif
+
+inline void Check(bool condition, const char* what) {
+    if (!condition) [[unlikely]] {
+        throw CheckedAccessError(what);
+    }
+}
+
+// lhs + rhs без переполнения и не больше max (проверяется только в проверяемом режиме)
+inline size_t AddSizes(size_t lhs, size_t rhs, size_t max) noexcept(!kVectorChecksEnabled) {
+    if constexpr (kVectorChecksEnabled) {
+        if (rhs > max || lhs > max - rhs) {
+            throw std::length_error("SimpleVector size exceeds the allocator's max_size");
+        }
+    }
+    return lhs + rhs;
+}
+
+#ifdef SIMPLE_VECTOR_CHECKED
+
+// Поколение хранилища вектора, меняющееся всякий раз, когда его итераторы становятся недействительными.
+// Копия начинает счёт заново: итераторы привязаны к вектору, а не к значению
+class IteratorGeneration {
+public:
+    IteratorGeneration() = default;
+
+    IteratorGeneration(const IteratorGeneration&) noexcept {
+    }
+
+    IteratorGeneration& operator=(const IteratorGeneration&) = delete;
+
+    size_t Get() const noexcept {
+        return value_;
+    }
+
+    void Bump() noexcept {
+        ++value_;
+    }
+
+private:
+    size_t value_ = 0;
+};
+
+// Итератор SimpleVector в проверяемом режиме: вектор, индекс и поколение на момент получения.
+// Разыменование и арифметика проверяют, что поколение не сменилось и индекс в границах.
+// Type - const Type для константного итератора
+template <typename Vector, typename Type>
+class CheckedIterator {
+    static constexpr bool kConst = std::is_const_v<Type>;
+    using Owner = std::conditional_t<kConst, const Vector, Vector>;
+
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<Type>;
+    using difference_type = std::ptrdiff_t;
+    using reference = Type&;
+    using pointer = Type*;
+
+    CheckedIterator() noexcept = default;
+
+    CheckedIterator(Owner* owner, size_t index) noexcept
+            : owner_(owner)
+            , index_(index)
+            , generation_(owner->generation_.Get())
+    {
+    }
+
+    operator CheckedIterator<Vector, const Type>() const noexcept requires(!kConst) {
+        CheckedIterator<Vector, const Type> result;
+        result.owner_ = owner_;
+        result.index_ = index_;
+        result.generation_ = generation_;
+        return result;
+    }
+
+    reference operator*() const {
+        return *Address(index_);
+    }
+
+    pointer operator->() const {
+        return Address(index_);
+    }
+
+    reference operator[](difference_type n) const {
+        return *Address(index_ + n);
+    }
+
+    CheckedIterator& operator++() {
+        return *this += 1;
+    }
+
+    CheckedIterator operator++(int) {
+        CheckedIterator old = *this;
+        *this += 1;
+        return old;
+    }
+
+    CheckedIterator& operator--() {
+        return *this -= 1;
+    }
+
+    CheckedIterator operator--(int) {
+        CheckedIterator old = *this;
+        *this -= 1;
+        return old;
+    }
+
+    CheckedIterator& operator+=(difference_type n) {
+        Validate();
+        const size_t index = index_ + n;
+        Check(index <= owner_->size_, "SimpleVector iterator moved out of range");
+        index_ = index;
+        return *this;
+    }
+
+    CheckedIterator& operator-=(difference_type n) {
+        return *this += -n;
+    }
+
+    friend CheckedIterator operator+(CheckedIterator it, difference_type n) {
+        return it += n;
+    }
+
+    friend CheckedIterator operator+(difference_type n, CheckedIterator it) {
+        return it += n;
+    }
+
+    friend CheckedIterator operator-(CheckedIterator it, difference_type n) {
+        return it -= n;
+    }
+
+    friend difference_type operator-(const CheckedIterator& lhs, const CheckedIterator& rhs) {
+        CheckComparable(lhs, rhs);
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const CheckedIterator& lhs, const CheckedIterator& rhs) {
+        CheckComparable(lhs, rhs);
+        return lhs.index_ == rhs.index_;
+    }
+
+    friend auto operator<=>(const CheckedIterator& lhs, const CheckedIterator& rhs) {
+        CheckComparable(lhs, rhs);
+        return lhs.index_ <=> rhs.index_;
+    }
+
+private:
+    template <typename, typename>
+    friend class CheckedIterator;
+
+    Owner* owner_ = nullptr;
+    size_t index_ = 0;
+    size_t generation_ = 0;
+
+    void Validate() const {
+        Check(owner_ != nullptr, "SimpleVector iterator is singular");
+        Check(generation_ == owner_->generation_.Get(), "SimpleVector iterator is invalidated");
+    }
+
+    Type* Address(size_t index) const {
+        Validate();
+        Check(index < owner_->size_, "SimpleVector iterator is out of range");
+        return owner_->items_.Get() + index;
+    }
+
+    static void CheckComparable(const CheckedIterator& lhs, const CheckedIterator& rhs) {
+        lhs.Validate();
+        rhs.Validate();
+        Check(lhs.owner_ == rhs.owner_, "SimpleVector iterators belong to different vectors");
+    }
+};
+
+#else
+
+struct IteratorGeneration {
+    size_t Get() const noexcept {
+        return 0;
+    }
+    void Bump() noexcept {
+    }
+};
+
+#endif
+
+}  // namespace detail
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <iterator>
+#include <type_traits>
+#include <utility>
+
+#include "memory_utils.h"
+
+// Общие для векторов с непрерывной памятью операции над блоком [data, data + capacity),
+// в котором сконструированы первые size элементов. Размер обновляется по ходу операции,
+// поэтому при исключении в блоке остаются только живые элементы
+namespace detail {
+
+template <typename It>
+inline constexpr bool kIsForwardIterator =
+        std::is_base_of_v<std::forward_iterator_tag, typename std::iterator_traits<It>::iterator_category>;
+
+// Вставляет value перед позицией p, когда в блоке есть свободное место
+template <typename Allocator, typename Type>
+void InsertInPlace(Allocator& alloc, Type* data, size_t& size, size_t p, Type&& value) {
+    Type* const slot = data + p;
+    if constexpr (kRelocateBitwise<Allocator, Type>) {
+        RelocateBitwise(slot, size - p, slot + 1);
+        try {
+            Construct(alloc, slot, std::move(value));
+        } catch (...) {
+            RelocateBitwise(slot + 1, size - p, slot);
+            throw;
+        }
+        ++size;
+    } else if (p == size) {
+        Construct(alloc, slot, std::move(value));
+        ++size;
+    } else {
+        // последний элемент переезжает в неинициализированный слот, остальные сдвигаются присваиванием
+        Construct(alloc, data + size, std::move(data[size - 1]));
+        ++size;
+        std::move_backward(slot, data + size - 2, data + size - 1);
+        *slot = std::move(value);
+    }
+}
+
+// Вставляет count элементов [first, last) перед позицией p, когда в блоке хватает свободного места
+template <typename Allocator, typename Type, typename ForwardIt>
+void InsertRangeInPlace(Allocator& alloc, Type* data, size_t& size, size_t p, size_t count,
+                        ForwardIt first, ForwardIt last) {
+    Type* const pos_ptr = data + p;
+    Type* const old_end = data + size;
+    const size_t elems_after = size - p;
+
+    if constexpr (kRelocateBitwise<Allocator, Type>) {
+        RelocateBitwise(pos_ptr, elems_after, pos_ptr + count);
+        try {
+            UninitializedCopy(alloc, first, last, pos_ptr);
+        } catch (...) {
+            RelocateBitwise(pos_ptr + count, elems_after, pos_ptr);
+            throw;
+        }
+        size += count;
+    } else if (elems_after > count) {
+        // хвост длиннее вставки: последние count элементов переезжают в свободную память,
+        // остальные сдвигаются присваиванием
+        UninitializedCopy(alloc, std::make_move_iterator(old_end - count), std::make_move_iterator(old_end), old_end);
+        size += count;
+        std::move_backward(pos_ptr, old_end - count, old_end);
+        std::copy(first, last, pos_ptr);
+    } else {
+        // вставка длиннее хвоста: её конец и весь хвост создаются в свободной памяти
+        ForwardIt mid = std::next(first, elems_after);
+        Type* const tail_dest = UninitializedCopy(alloc, mid, last, old_end);
+        size += count - elems_after;
+        UninitializedCopy(alloc, std::make_move_iterator(pos_ptr), std::make_move_iterator(old_end), tail_dest);
+        size += elems_after;
+        std::copy(first, mid, pos_ptr);
+    }
+}
+
+// Удаляет count элементов начиная с позиции p, сдвигая хвост один раз
+template <typename Allocator, typename Type>
+void EraseRange(Allocator& alloc, Type* data, size_t& size, size_t p, size_t count) noexcept(
+        kRelocateBitwise<Allocator, Type> || std::is_nothrow_move_assignable_v<Type>) {
+    Type* const range = data + p;
+    if constexpr (kRelocateBitwise<Allocator, Type>) {
+        DestroyN(alloc, range, count);
+        RelocateBitwise(range + count, size - p - count, range);
+    } else {
+        std::move(range + count, data + size, range);
+        DestroyN(alloc, data + size - count, count);
+    }
+    size -= count;
+}
+
+// Заменяет содержимое блока вместимостью не меньше count копиями [first, last),
+// переиспользуя уже сконструированные элементы
+template <typename Allocator, typename Type, typename ForwardIt>
+void AssignInPlace(Allocator& alloc, Type* data, size_t& size, size_t count, ForwardIt first, ForwardIt last) {
+    if (count <= size) {
+        std::copy(first, last, data);
+        DestroyN(alloc, data + count, size - count);
+    } else {
+        ForwardIt mid = std::next(first, size);
+        std::copy(first, mid, data);
+        UninitializedCopy(alloc, mid, last, data + size);
+    }
+    size = count;
+}
+
+// Переносит size элементов из old_data в новый блок new_data вокруг уже заполненного промежутка
+// [new_data + index, new_data + index + gap_size). При исключении разрушает промежуток,
+// при успехе исходные элементы больше не существуют
+template <typename Allocator, typename Type>
+void RelocateAroundGap(Allocator& alloc, Type* old_data, size_t size, Type* new_data, size_t index, size_t gap_size) {
+    if constexpr (kRelocateBitwise<Allocator, Type>) {
+        // старая память освободится без вызова деструкторов перенесённых элементов
+        RelocateBitwise(old_data, index, new_data);
+        RelocateBitwise(old_data + index, size - index, new_data + index + gap_size);
+    } else {
+        try {
+            UninitializedRelocateN(alloc, old_data, index, new_data);
+        } catch (...) {
+            DestroyN(alloc, new_data + index, gap_size);
+            throw;
+        }
+        try {
+            UninitializedRelocateN(alloc, old_data + index, size - index, new_data + index + gap_size);
+        } catch (...) {
+            DestroyN(alloc, new_data, index + gap_size);
+            throw;
+        }
+        DestroyN(alloc, old_data, size);
+    }
+}
+
+}  // namespace detail
@@ -0,0 +1,219 @@
+#pragma once
+
+#include <bit>
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <istream>
+#include <limits>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "simple_span.h"
+#include "simple_vector.h"
+
+// Двоичный формат SimpleVector тривиально копируемых элементов: заголовок, за которым сразу
+// идут байты элементов в порядке памяти. Данные пишутся одним write/writev прямо из буфера вектора
+// и читаются прямо в новый буфер, без поэлементной обработки и промежуточных копий.
+// Порядок байтов не преобразуется: файл другого порядка байтов или с другим размером
+// и выравниванием элементов отвергается при чтении
+struct SerializedVectorHeader {
+    static constexpr char kMagic[4] = {'S', 'V', 'E', 'C'};
+    static constexpr uint16_t kVersion = 1;
+    static constexpr uint8_t kLittleEndian = 1;
+    static constexpr uint8_t kBigEndian = 2;
+
+    char magic[4] = {kMagic[0], kMagic[1], kMagic[2], kMagic[3]};
+    uint16_t version = kVersion;
+    uint8_t endianness = std::endian::native == std::endian::little ? kLittleEndian : kBigEndian;
+    uint8_t reserved = 0;
+    uint32_t element_size = 0;
+    uint32_t alignment = 0;
+    uint64_t size = 0;
+};
+
+static_assert(sizeof(SerializedVectorHeader) == 24 && std::is_trivially_copyable_v<SerializedVectorHeader>);
+
+namespace detail {
+
+template <typename Type>
+SerializedVectorHeader MakeHeader(size_t size) noexcept {
+    SerializedVectorHeader header;
+    header.element_size = sizeof(Type);
+    header.alignment = alignof(Type);
+    header.size = size;
+    return header;
+}
+
+// Проверяет, что заголовок описывает вектор элементов Type в формате этой платформы
+template <typename Type>
+size_t CheckHeader(const SerializedVectorHeader& header) {
+    const SerializedVectorHeader expected = MakeHeader<Type>(0);
+    if (std::memcmp(header.magic, expected.magic, sizeof(header.magic)) != 0) {
+        throw std::runtime_error("not a serialized SimpleVector");
+    }
+    if (header.version != expected.version) {
+        throw std::runtime_error("unsupported SimpleVector format version");
+    }
+    if (header.endianness != expected.endianness) {
+        throw std::runtime_error("serialized SimpleVector has a different byte order");
+    }
+    if (header.element_size != expected.element_size || header.alignment != expected.alignment) {
+        throw std::runtime_error("serialized SimpleVector has a different element layout");
+    }
+    if (header.size > std::numeric_limits<size_t>::max() / sizeof(Type)) {
+        throw std::runtime_error("serialized SimpleVector is too large");
+    }
+    return static_cast<size_t>(header.size);
+}
+
+// Дописывает все байты, повторяя writev после частичной записи и прерывания сигналом
+inline void WriteAll(int fd, iovec* parts, int count) {
+    while (count > 0) {
+        const ssize_t result = ::writev(fd, parts, count);
+        if (result < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+        // пропускаем записанные части и сдвигаем начало частично записанной
+        size_t written = static_cast<size_t>(result);
+        while (count > 0 && written >= parts->iov_len) {
+            written -= parts->iov_len;
+            ++parts;
+            --count;
+        }
+        if (count > 0) {
+            parts->iov_base = static_cast<char*>(parts->iov_base) + written;
+            parts->iov_len -= written;
+        }
+    }
+}
+
+inline void ReadAll(int fd, void* data, size_t bytes) {
+    auto* dest = static_cast<char*>(data);
+    while (bytes > 0) {
+        const ssize_t read = ::read(fd, dest, bytes);
+        if (read < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (read == 0) {
+            throw std::runtime_error("serialized SimpleVector is truncated");
+        }
+        dest += read;
+        bytes -= static_cast<size_t>(read);
+    }
+}
+
+// Создаёт вектор из size элементов, байты которых читает read_bytes(data, bytes)
+template <typename Type, typename Allocator, typename GrowthPolicy, typename ReadBytes>
+void ReadElements(SimpleVector<Type, Allocator, GrowthPolicy>& vector, size_t size, ReadBytes&& read_bytes) {
+    using Vector = SimpleVector<Type, Allocator, GrowthPolicy>;
+    Vector result = Vector::FromUninitialized(size, [&](Type* data, size_t count) {
+        read_bytes(static_cast<void*>(data), count * sizeof(Type));
+    }, vector.GetAllocator());
+    vector.swap(result);
+}
+
+}  // namespace detail
+
+// Вид пишется в том же формате, что и вектор, поэтому срез читается обратно как SimpleVector
+template <typename Type>
+void WriteTo(SimpleSpan<Type> span, std::ostream& out) {
+    using Value = std::remove_cv_t<Type>;
+    static_assert(std::is_trivially_copyable_v<Value>, "only trivially copyable elements can be serialized");
+    const SerializedVectorHeader header = detail::MakeHeader<Value>(span.GetSize());
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    out.write(reinterpret_cast<const char*>(span.Get()), static_cast<std::streamsize>(span.GetSize() * sizeof(Value)));
+    if (!out) {
+        throw std::runtime_error("failed to write SimpleVector");
+    }
+}
+
+// Заголовок и данные уходят одним вызовом writev
+template <typename Type>
+void WriteTo(SimpleSpan<Type> span, int fd) {
+    using Value = std::remove_cv_t<Type>;
+    static_assert(std::is_trivially_copyable_v<Value>, "only trivially copyable elements can be serialized");
+    SerializedVectorHeader header = detail::MakeHeader<Value>(span.GetSize());
+    iovec parts[2] = {
+            {&header, sizeof(header)},
+            {const_cast<Value*>(span.Get()), span.GetSize() * sizeof(Value)},
+    };
+    detail::WriteAll(fd, parts, 2);
+}
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+void WriteTo(const SimpleVector<Type, Allocator, GrowthPolicy>& vector, std::ostream& out) {
+    WriteTo(SimpleSpan(vector), out);
+}
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+void WriteTo(const SimpleVector<Type, Allocator, GrowthPolicy>& vector, int fd) {
+    WriteTo(SimpleSpan(vector), fd);
+}
+
+// Заменяет содержимое vector прочитанным; при ошибке vector не меняется
+template <typename Type, typename Allocator, typename GrowthPolicy>
+void ReadFrom(SimpleVector<Type, Allocator, GrowthPolicy>& vector, std::istream& in) {
+    static_assert(std::is_trivially_copyable_v<Type>, "only trivially copyable elements can be serialized");
+    const auto read_bytes = [&in](void* data, size_t bytes) {
+        in.read(static_cast<char*>(data), static_cast<std::streamsize>(bytes));
+        if (static_cast<size_t>(in.gcount()) != bytes) {
+            throw std::runtime_error("serialized SimpleVector is truncated");
+        }
+    };
+    SerializedVectorHeader header;
+    read_bytes(&header, sizeof(header));
+    detail::ReadElements(vector, detail::CheckHeader<Type>(header), read_bytes);
+}
+
+template <typename Type, typename Allocator, typename GrowthPolicy>
+void ReadFrom(SimpleVector<Type, Allocator, GrowthPolicy>& vector, int fd) {
+    static_assert(std::is_trivially_copyable_v<Type>, "only trivially copyable elements can be serialized");
+    SerializedVectorHeader header;
+    detail::ReadAll(fd, &header, sizeof(header));
+    detail::ReadElements(vector, detail::CheckHeader<Type>(header), [fd](void* data, size_t bytes) {
+        detail::ReadAll(fd, data, bytes);
+    });
+}
+
+// Читает вектор ровно из span.GetSize() элементов прямо в память вида
+template <typename Type>
+void ReadFrom(SimpleSpan<Type> span, std::istream& in) {
+    static_assert(std::is_trivially_copyable_v<Type>, "only trivially copyable elements can be serialized");
+    SerializedVectorHeader header;
+    in.read(reinterpret_cast<char*>(&header), sizeof(header));
+    if (in.gcount() != sizeof(header)) {
+        throw std::runtime_error("serialized SimpleVector is truncated");
+    }
+    if (detail::CheckHeader<Type>(header) != span.GetSize()) {
+        throw std::runtime_error("serialized SimpleVector size does not match the span");
+    }
+    const auto bytes = static_cast<std::streamsize>(span.GetSize() * sizeof(Type));
+    in.read(reinterpret_cast<char*>(span.Get()), bytes);
+    if (in.gcount() != bytes) {
+        throw std::runtime_error("serialized SimpleVector is truncated");
+    }
+}
+
+template <typename Type>
+void ReadFrom(SimpleSpan<Type> span, int fd) {
+    static_assert(std::is_trivially_copyable_v<Type>, "only trivially copyable elements can be serialized");
+    SerializedVectorHeader header;
+    detail::ReadAll(fd, &header, sizeof(header));
+    if (detail::CheckHeader<Type>(header) != span.GetSize()) {
+        throw std::runtime_error("serialized SimpleVector size does not match the span");
+    }
+    detail::ReadAll(fd, span.Get(), span.GetSize() * sizeof(Type));
+}
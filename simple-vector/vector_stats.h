@@ -0,0 +1,131 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+
+// Счётчики работы с памятью SimpleVector. Собираются, только если до подключения simple_vector.h
+// определён макрос SIMPLE_VECTOR_STATS; иначе счётчик - пустой тип и ничего не стоит
+struct VectorStats {
+    size_t allocations = 0;       // выделенные блоки
+    size_t bytes_allocated = 0;   // их суммарный размер
+    size_t reallocations = 0;     // переезды уже существующих элементов в новый блок
+    size_t elements_moved = 0;    // элементы, перенесённые при переезде или сдвинутые Insert/Erase
+    size_t elements_copied = 0;   // элементы, скопированные из другого вектора или диапазона
+    size_t peak_capacity = 0;     // наибольшая вместимость (для глобальной статистики - по всем векторам)
+};
+
+namespace detail {
+
+#ifdef SIMPLE_VECTOR_STATS
+
+inline constexpr bool kVectorStatsEnabled = true;
+
+struct GlobalVectorStats {
+    std::atomic<size_t> allocations{0};
+    std::atomic<size_t> bytes_allocated{0};
+    std::atomic<size_t> reallocations{0};
+    std::atomic<size_t> elements_moved{0};
+    std::atomic<size_t> elements_copied{0};
+    std::atomic<size_t> peak_capacity{0};
+};
+
+inline GlobalVectorStats global_vector_stats;
+
+// Счётчик одного вектора, дублирующий всё в глобальную статистику.
+// Копия и перемещённый вектор начинают счёт заново: статистика не часть значения
+class StatsCounter {
+public:
+    StatsCounter() = default;
+
+    StatsCounter(const StatsCounter&) noexcept {
+    }
+
+    StatsCounter& operator=(const StatsCounter&) noexcept {
+        return *this;
+    }
+
+    void OnAllocate(size_t capacity, size_t bytes) noexcept {
+        ++stats_.allocations;
+        stats_.bytes_allocated += bytes;
+        stats_.peak_capacity = std::max(stats_.peak_capacity, capacity);
+
+        global_vector_stats.allocations.fetch_add(1, std::memory_order_relaxed);
+        global_vector_stats.bytes_allocated.fetch_add(bytes, std::memory_order_relaxed);
+        size_t peak = global_vector_stats.peak_capacity.load(std::memory_order_relaxed);
+        while (peak < capacity &&
+               !global_vector_stats.peak_capacity.compare_exchange_weak(peak, capacity, std::memory_order_relaxed)) {
+        }
+    }
+
+    void OnReallocate() noexcept {
+        ++stats_.reallocations;
+        global_vector_stats.reallocations.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void OnMove(size_t count) noexcept {
+        stats_.elements_moved += count;
+        global_vector_stats.elements_moved.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    void OnCopy(size_t count) noexcept {
+        stats_.elements_copied += count;
+        global_vector_stats.elements_copied.fetch_add(count, std::memory_order_relaxed);
+    }
+
+    VectorStats Get() const noexcept {
+        return stats_;
+    }
+
+private:
+    VectorStats stats_;
+};
+
+#else
+
+inline constexpr bool kVectorStatsEnabled = false;
+
+struct StatsCounter {
+    void OnAllocate(size_t, size_t) noexcept {
+    }
+    void OnReallocate() noexcept {
+    }
+    void OnMove(size_t) noexcept {
+    }
+    void OnCopy(size_t) noexcept {
+    }
+    VectorStats Get() const noexcept {
+        return {};
+    }
+};
+
+#endif
+
+}  // namespace detail
+
+// Суммарная статистика всех SimpleVector программы (нули, если SIMPLE_VECTOR_STATS не определён)
+inline VectorStats GetGlobalVectorStats() noexcept {
+    VectorStats result;
+#ifdef SIMPLE_VECTOR_STATS
+    const auto& global = detail::global_vector_stats;
+    result.allocations = global.allocations.load(std::memory_order_relaxed);
+    result.bytes_allocated = global.bytes_allocated.load(std::memory_order_relaxed);
+    result.reallocations = global.reallocations.load(std::memory_order_relaxed);
+    result.elements_moved = global.elements_moved.load(std::memory_order_relaxed);
+    result.elements_copied = global.elements_copied.load(std::memory_order_relaxed);
+    result.peak_capacity = global.peak_capacity.load(std::memory_order_relaxed);
+#endif
+    return result;
+}
+
+inline void ResetGlobalVectorStats() noexcept {
+#ifdef SIMPLE_VECTOR_STATS
+    auto& global = detail::global_vector_stats;
+    global.allocations.store(0, std::memory_order_relaxed);
+    global.bytes_allocated.store(0, std::memory_order_relaxed);
+    global.reallocations.store(0, std::memory_order_relaxed);
+    global.elements_moved.store(0, std::memory_order_relaxed);
+    global.elements_copied.store(0, std::memory_order_relaxed);
+    global.peak_capacity.store(0, std::memory_order_relaxed);
+#endif
+}